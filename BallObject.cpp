@@ -11,8 +11,8 @@
 BallObject::BallObject()
     : GameObject(), _radius(12.5f), _stuck(GL_TRUE), _sticky(GL_FALSE), _passThrough(GL_FALSE)  { }
 
-BallObject::BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D&& sprite)
-:  GameObject(pos, glm::vec2(radius * 2, radius * 2), std::move(sprite), glm::vec3(1.0f), velocity), _radius(radius), _stuck(true) { }
+BallObject::BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, TextureView sprite)
+:  GameObject(pos, glm::vec2(radius * 2, radius * 2), sprite, glm::vec3(1.0f), velocity), _radius(radius), _stuck(true) { }
 
 glm::vec2 BallObject::move(float dt, GLuint window_width){
     // If not stuck to player board
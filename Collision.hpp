@@ -0,0 +1,113 @@
+//
+//  Collision.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <tuple>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "GameObject.hpp"
+#include "BallObject.hpp"
+#include "GameModel.hpp"
+
+// Collision tests between game objects, shared by the game, the batched
+// narrowphase (Narrowphase) and the benchmarks (Tools/Microbenchmarks)
+
+// The Circle - AABB test has to give the same bits in every kernel, so no multiply may be fused
+// with an add into an FMA (rounded once instead of twice). GCC does that across statements by
+// default (-ffp-contract=fast) wherever the target has FMA, e.g. -march=haswell, so contraction
+// is turned off for the functions involved. Clang only contracts within one expression by default,
+// which they avoid; builds passing -ffp-contract=fast to clang break the guarantee
+#if defined(__GNUC__) && !defined(__clang__)
+#define COLLISION_NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define COLLISION_NO_FP_CONTRACT
+#endif
+
+// Defines a Collision typedef that represents collision data
+typedef std::tuple<bool, Direction, glm::vec2> Collision;
+
+// AABB - AABB collisions detection
+//Rectangle collision
+inline bool checkCollision(const GameObject &one, const GameObject &two);
+// Circle collision --Specially for BallObject, returns if collides and direction and new vector
+COLLISION_NO_FP_CONTRACT inline Collision checkCollision(const BallObject &one, const GameObject &two);
+// Vector Direction -- Returns the Vector Direction after a collision
+inline Direction vectorDirection(glm::vec2 target);
+// Circle - AABB test shared by checkCollision and the batched kernels
+COLLISION_NO_FP_CONTRACT inline bool circleBoxContact(float centerX, float centerY, float radius,
+                             float boxCenterX, float boxCenterY, float halfWidth, float halfHeight,
+                             glm::vec2 &difference);
+
+inline bool checkCollision(const GameObject &one, const GameObject &two){ // AABB - Rectangle collision
+    // Collision x-axis?
+    bool collisionX = one._position.x + one._size.x >= two._position.x &&
+        two._position.x + two._size.x >= one._position.x;
+    // Collision y-axis?
+    bool collisionY = one._position.y + one._size.y >= two._position.y &&
+        two._position.y + two._size.y >= one._position.y;
+    // Collision only if on both axes
+    return collisionX && collisionY;
+}
+
+// Circle - AABB test on precomputed centres and half extents. This is the reference the batched
+// kernels (Narrowphase) must match bit for bit, so every step is a single IEEE operation they can
+// repeat in the same order: no sqrt (squared distances are compared) and no normalisation
+inline bool circleBoxContact(float centerX, float centerY, float radius,
+                             float boxCenterX, float boxCenterY, float halfWidth, float halfHeight,
+                             glm::vec2 &difference){
+    // Closest point of the box to the circle centre (glm::clamp keeps the value on ties)
+    float closestX = boxCenterX + glm::clamp(centerX - boxCenterX, -halfWidth, halfWidth);
+    float closestY = boxCenterY + glm::clamp(centerY - boxCenterY, -halfHeight, halfHeight);
+    // Vector between the circle centre and that point, colliding if its length <= radius
+    difference = glm::vec2(closestX - centerX, closestY - centerY);
+    // Two statements, so clang's default contraction (within an expression) cannot fuse them; GCC
+    // is kept from it by COLLISION_NO_FP_CONTRACT
+    float distance2 = difference.x * difference.x;
+    distance2 += difference.y * difference.y;
+    return distance2 <= radius * radius;
+}
+
+inline Collision checkCollision(const BallObject &one, const GameObject &two){ // AABB - Circle collision
+    // Get center point circle first
+    glm::vec2 center(one._position + one._radius);
+    // Calculate AABB info (center, half-extents)
+    glm::vec2 aabb_half_extents(two._size.x / 2, two._size.y / 2);
+    glm::vec2 aabb_center(
+        two._position.x + aabb_half_extents.x,
+        two._position.y + aabb_half_extents.y
+    );
+    glm::vec2 difference;
+    if (circleBoxContact(center.x, center.y, one._radius, aabb_center.x, aabb_center.y,
+                         aabb_half_extents.x, aabb_half_extents.y, difference)){
+        return std::make_tuple(GL_TRUE, vectorDirection(difference), difference);
+    }else {
+        return std::make_tuple(GL_FALSE, UP, glm::vec2(0, 0));
+    }
+}
+
+// Calculates which direction a vector is facing (N,E,S or W): its largest positive component, the
+// first of up, right, down, left on ties. A zero vector (the ball's centre inside the brick) faces down
+inline Direction vectorDirection(glm::vec2 target){
+    float components[] = {
+        target.y,   // up
+        target.x,   // right
+        -target.y,  // down
+        -target.x   // left
+    };
+    float max = 0.0f;
+    int best_match = DOWN;
+    for (int i = 0; i < 4; i++){
+        if (components[i] > max){
+            max = components[i];
+            best_match = i;
+        }
+    }
+    return static_cast<Direction>(best_match);
+}
@@ -0,0 +1,96 @@
+//
+//  CollisionStage.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "CollisionStage.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // The ball's box is grown by this much (pixels) so rounding in the narrowphase cannot find a
+    // contact the broadphase left out
+    const float MARGIN = 1.0f;
+
+    std::size_t floorBatch(std::size_t index) { return index / BrickSoA::BATCH * BrickSoA::BATCH; }
+    std::size_t ceilBatch(std::size_t index) { return floorBatch(index + BrickSoA::BATCH - 1); }
+}
+
+void CollisionStage::setBricks(std::vector<std::vector<GameObject>>& rows){
+    _bricks.assign(rows);
+    _objects.clear();
+    _rows.clear();
+    _left.clear();
+    _right.clear();
+    _ordered = true;
+    for (auto& bricks : rows){
+        if (bricks.empty())
+            continue;
+        Row row = { bricks[0]._position.y, bricks[0]._position.y + bricks[0]._size.y, _objects.size(), _objects.size() + bricks.size() };
+        for (GameObject& brick : bricks){
+            float left = brick._position.x;
+            float right = brick._position.x + brick._size.x;
+            if (_objects.size() > row.Begin && (left < _left.back() || right < _right.back()))
+                _ordered = false;
+            row.Top = std::min(row.Top, brick._position.y);
+            row.Bottom = std::max(row.Bottom, brick._position.y + brick._size.y);
+            _objects.push_back(&brick);
+            _left.push_back(left);
+            _right.push_back(right);
+        }
+        if (!_rows.empty() && (row.Top < _rows.back().Top || row.Bottom < _rows.back().Bottom))
+            _ordered = false;
+        _rows.push_back(row);
+    }
+}
+
+const std::vector<BrickContact>& CollisionStage::gather(const BallObject& ball){
+    _tick = CollisionCounters();
+    _tick.Ticks = 1;
+    _hits.clear();
+    if (_ordered){
+        float minX = ball._position.x - MARGIN;
+        float maxX = ball._position.x + 2.0f * ball._radius + MARGIN;
+        float minY = ball._position.y - MARGIN;
+        float maxY = ball._position.y + 2.0f * ball._radius + MARGIN;
+        // Bricks [begin, end) of every row the box overlaps. Ranges closer than a batch are merged, as
+        // the narrowphase widens them to whole batches and would otherwise test some bricks twice
+        std::size_t begin = 0, end = 0;
+        auto row = std::lower_bound(_rows.begin(), _rows.end(), minY, [](const Row& row, float y){ return row.Bottom < y; });
+        for (; row != _rows.end() && row->Top <= maxY; ++row){
+            std::size_t first = std::lower_bound(_right.begin() + row->Begin, _right.begin() + row->End, minX) - _right.begin();
+            std::size_t last = std::upper_bound(_left.begin() + first, _left.begin() + row->End, maxX) - _left.begin();
+            if (first >= last)
+                continue;
+            if (begin < end && floorBatch(first) < ceilBatch(end)){
+                end = last;
+                continue;
+            }
+            if (begin < end)
+                _tick.PairsTested += Narrowphase::collide(ball, _bricks, begin, end, _hits);
+            begin = first;
+            end = last;
+        }
+        if (begin < end)
+            _tick.PairsTested += Narrowphase::collide(ball, _bricks, begin, end, _hits);
+    }
+    else
+        _tick.PairsTested += Narrowphase::collide(ball, _bricks, _hits);
+
+    _contacts.clear();
+    for (const Contact& hit : _hits){
+        bool horizontal = hit.Dir == LEFT || hit.Dir == RIGHT;
+        _contacts.push_back({ hit, ball._radius - std::abs(horizontal ? hit.Difference.x : hit.Difference.y) });
+    }
+    std::sort(_contacts.begin(), _contacts.end(), [](const BrickContact& one, const BrickContact& two){
+        return one.Penetration != two.Penetration ? one.Penetration > two.Penetration : one.Hit.Brick < two.Hit.Brick;
+    });
+    _tick.Contacts = _contacts.size();
+    _totals.Ticks += 1;
+    _totals.PairsTested += _tick.PairsTested;
+    _totals.Contacts += _tick.Contacts;
+    return _contacts;
+}
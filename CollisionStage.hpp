@@ -0,0 +1,67 @@
+//
+//  CollisionStage.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Narrowphase.hpp"
+
+// Ball - brick collision work, per tick or in total
+struct CollisionCounters {
+    uint64_t Ticks = 0;
+    uint64_t PairsTested = 0; // Ball - brick pairs the narrowphase tested
+    uint64_t Contacts = 0;    // Pairs found touching
+    uint64_t Resolved = 0;    // Contacts that moved and bounced the ball (at most one per axis per tick)
+};
+
+// A ball touching a brick, with how deep it is in along its axis
+struct BrickContact {
+    Contact Hit;
+    float   Penetration;
+};
+
+// CollisionStage finds every brick the ball touches in one go, before any
+// of them is resolved, so the outcome does not depend on brick order.
+// Broadphase: bricks are kept in rows ordered by x, and only the rows and
+// the x range the ball's box overlaps go to the narrowphase (Narrowphase,
+// on the widest kernel the CPU runs). The contacts come out deepest first.
+class CollisionStage{
+public:
+    // Takes the bricks of the rows (as GameView lays them out). Call again whenever the rows change:
+    // bricks are kept by address
+    void setBricks(std::vector<std::vector<GameObject>>& rows);
+    // Every live brick the ball touches, deepest first (ties in brick order)
+    const std::vector<BrickContact>& gather(const BallObject& ball);
+    GameObject& brick(uint32_t index) { return *_objects[index]; }
+    // Takes a destroyed brick out of later ticks
+    void remove(uint32_t index) { _bricks.park(index); }
+    // Counts a contact that moved the ball
+    void resolved() { ++_tick.Resolved; ++_totals.Resolved; }
+    // Counters of the last tick, and since the game started
+    const CollisionCounters& lastTick() const { return _tick; }
+    const CollisionCounters& totals() const { return _totals; }
+private:
+    // A row of bricks: its vertical extent and where its bricks are in _bricks
+    struct Row {
+        float Top, Bottom;
+        std::size_t Begin, End;
+    };
+    BrickSoA _bricks;
+    std::vector<GameObject*> _objects;
+    // Broadphase: the rows by Top, and each brick's horizontal extent (kept when it is parked)
+    std::vector<Row> _rows;
+    std::vector<float> _left, _right;
+    // Whether the rows and the bricks in each row are ordered; if not every brick is tested
+    bool _ordered = true;
+    std::vector<Contact> _hits;
+    std::vector<BrickContact> _contacts;
+    CollisionCounters _tick;
+    CollisionCounters _totals;
+};
@@ -16,6 +16,10 @@
  ******************************************************************/
 #include "Game.hpp"
 #include "ResourceManager.hpp"
+#include "Profiler.hpp"
+#include "Clock.hpp"
+
+#include <algorithm>
 
 //Constants
 /// Initial size of the player paddle
@@ -26,32 +30,40 @@ constexpr float PLAYER_VELOCITY = (500.0f*1/60);
 const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
 /// Radius of the ball object
 const float BALL_RADIUS = 12.5f;
+/// Lives at the start of a game
+const GLuint INITIAL_LIVES = 3;
 
 
-// AABB - AABB collisions detection
-//Rectangle collision
-inline bool checkCollision(GameObject &one, GameObject &two);
-// Circle collision --Specially for BallObject, returns if collides and direction and new vector
-inline Collision checkCollision(BallObject &one, GameObject &two);
-// Vector Direction -- Returns the Vector Direction after a collision
-inline Direction vectorDirection(glm::vec2 target);
 //Calculates probability of spawning and returns if it lands in that probability
 inline bool shouldSpawn(GLuint chance);
 //It might happen that while one of the powerup effects is active, another powerup of the same type collides with the player paddle. In that case we have more than 1 powerup of that type currently active within the game's PowerUps vector. Then, whenever one of these powerups gets deactivated, we don't want to disable its effects yet since another powerup of the same type might still be active.
 inline bool isOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type);
+// What the renderer needs to draw the object
+inline SpriteInstance spriteOf(const GameObject &object);
+// How far the paddle moves for one key poll in dir (0 when it is against that edge)
+inline float paddleStep(float x, float paddleWidth, GLuint screenWidth, Direction dir);
+// Whether two snapshots draw the same image (the debug overlay aside)
+inline bool looksSame(const RenderSnapshot &a, const RenderSnapshot &b);
+// The tile types of a board, as GameView takes them
+inline std::vector<std::vector<TileType>> tileTypesOf(const TileBoard &board);
 
 
 Game::Game(GLuint width, GLuint height)
-: _width(width), _height(height){
+: _width(width), _height(height), _lives(INITIAL_LIVES){
     _model = std::make_unique<GameModel>();
     _view = std::make_unique<GameView>(width,height);
     //register the callbacks
     _model->toggleChaosEffect([this](bool toggle){ return Game::OnChaosEffectTriggered(toggle);});
     _model->toggleBallStuck([this](bool toggle){ return Game::OnBallStuck(toggle);});
     _model->setKeyPressHandler([this](Direction dir){return Game::onKeyPressed(dir);});
+    // Debug keys act on the renderer, which picks the presses up from the next snapshot
+    _model->setToggleOverlayHandler([this](){ ++_overlayToggles; });
+    _model->setCycleAntiAliasingHandler([this](){ ++_antiAliasingCycles; });
+    _model->setCycleBloomHandler([this](){ ++_bloomCycles; });
 }
 
 Game::~Game(){
+    stopSimulationThread();
     delete _renderer;
     delete _particles;
     delete _effects;
@@ -66,32 +78,38 @@ void Game::init(){
     
     auto loadedLevel = boardsArray[_model->currentLevel()];//by default level zero
     
-    std::vector<std::vector<TileType>> lol;
-    
-    lol.reserve(loadedLevel.size());
-    
-    int yTiles =  static_cast<int>(loadedLevel.size());
-    int xTiles =  static_cast<int>(loadedLevel[0].size());
-    
-    std::vector<TileType> row;
-    
-    for (int y = 0; y < yTiles; ++y){
-        row.reserve(xTiles);
-        for (int x = 0; x < xTiles; ++x){
-            row.push_back(loadedLevel[y][x].tileType);
-        }
-        lol.push_back(row);
-        row.clear();
-    }
-    
-    _view->init(lol);
+    _view->init(tileTypesOf(loadedLevel));
+    bricksChanged();
     
     
     // Set render-specific controls
     _renderer    = new SpriteRenderer(ResourceManager::getShader("sprite"));
-    _effects     = new PostProcessor(ResourceManager::getShader("postprocessing"), _width, _height);
+    _effects     = new PostProcessor("Resources/shaders/post_processing.vs", "Resources/shaders/post_processing.frag", _width, _height);
+    setAntiAliasing(_msaaSamples, _fxaa);
+    // Bloom goes first in the chain: its composite adds the glow to the chain's input
+    _bloom       = std::make_unique<Bloom>(_effects->chain());
+    setBloomQuality(_bloomQuality);
+    // Arcade cabinet look: both are pixel passes, so the chain fuses them into a single draw
+    EffectPass grade;
+    grade.Name = "grade";
+    grade.PixelFile = "Resources/shaders/effects/color_grade.glsl";
+    grade.SetUniforms = [](Shader& shader){
+        shader.setFloat("grade_contrast", 1.1f);
+        shader.setFloat("grade_saturation", 1.2f);
+        shader.setVector3f("grade_tint", 1.0f, 0.97f, 0.92f);
+    };
+    _effects->chain().add(std::move(grade));
+    EffectPass scanlines;
+    scanlines.Name = "scanlines";
+    scanlines.PixelFile = "Resources/shaders/effects/crt_scanlines.glsl";
+    scanlines.SetUniforms = [](Shader& shader){ shader.setFloat("scanlines_strength", 0.25f); };
+    _effects->chain().add(std::move(scanlines));
+    setCrtEffect(_crt);
     _text        = new TextRenderer(_width, _height);
     _text->load("Resources/fonts/ocraext.TTF", 24);
+    _overlay     = std::make_unique<DebugOverlay>(_width, _height);
+    _brickLayer  = std::make_unique<BrickLayer>(_width, _height);
+    _gpuProfiler = std::make_unique<GpuProfiler>();
     //Setup Particle System
     _particles   = new  ParticleGenerator(ResourceManager::getShader("particle"),
                                          ResourceManager::getTexture("particle"),
@@ -106,88 +124,359 @@ void Game::init(){
     //Effects->Shake = GL_TRUE;
     //Effects->Confuse = GL_TRUE;
     //Effects->Chaos = GL_TRUE;
+    
+    // The renderer always has a snapshot to draw
+    publishSnapshot();
+}
+
+void Game::loadLevel(const GameLevel& level){
+    if (level._boardData.empty() || level._boardData[0].empty()){
+        std::cout << "ERROR::GAME: Cannot load an empty level" << std::endl;
+        return;
+    }
+    _view->loadLevel(tileTypesOf(_model->setLevel(level)));
+    bricksChanged();
+    _powerUpsVector.clear();
+    resetPlayer();
+    publishSnapshot();
+}
+
+void Game::setAutoplay(bool enabled){
+    _autoplay = enabled;
+    if (enabled)
+        _model->pushState(GAME_ACTIVE);
 }
 
 void Game::update(float dt){
+    PROFILE_SCOPE("Game::update");
+    uint64_t tickStart = Clock::now();
+    if (_lastTickStart)
+        _tickIntervals.add((tickStart - _lastTickStart) / 1e6);
+    _lastTickStart = tickStart;
+    _time += Clock::fromSeconds(dt);
+    if (_autoplay && _model->getState() == GAME_ACTIVE){
+        // Paddle centred under the ball, as far as the screen edges allow
+        float x = _ball->_position.x + _ball->_radius - _player->_size.x / 2;
+        _player->_position.x = std::max(0.0f, std::min(x, _width - _player->_size.x));
+        _ball->_stuck = false;
+    }
     // Update objects
-    _ball->move(dt, _width);
+    {
+        PROFILE_SCOPE("Ball::move");
+        _ball->move(dt, _width);
+    }
     // Check for collisions
-    doCollisions();//TODO: only do this while in game
+    {
+        PROFILE_SCOPE("Game::doCollisions");
+        doCollisions();//TODO: only do this while in game
+    }
     // Update particles
-    _particles->update(dt, *_ball, 2, glm::vec2(_ball->_radius / 2));
+    {
+        PROFILE_SCOPE("Particles::update");
+        // The ball only trails particles in play: the menu and win screens settle once the trail fades
+        GLuint newParticles = _model->getState() == GAME_ACTIVE ? 2 : 0;
+        _particles->update(dt, *_ball, newParticles, glm::vec2(_ball->_radius / 2));
+    }
     // Update PowerUps
-    updatePowerUps(dt);
+    {
+        PROFILE_SCOPE("Game::updatePowerUps");
+        updatePowerUps(dt);
+    }
     //slowly get shake time back to zero
     if (_shakeTime > 0.0f){
         _shakeTime -= dt;
         if (_shakeTime <= 0.0f)
-            _effects->Shake = false;
+            _shake = false;
     }
-    // Check loss condition
-    if (_ball->_position.y >= _height){ // Did ball reach bottom edge?
-        --_lives;
-        // Did the player lose all his lives? : Game over
-        if (_lives == 0){
+    // Check win condition
+    {
+        PROFILE_SCOPE("GameModel::isCompleted");
+        if(_model->getState() == GAME_ACTIVE && _model->isCompleted()){//TODO:: very expensive check
             resetLevel();
-            _model->pushState(GAME_MENU);
+            resetPlayer();
+            _chaos = GL_TRUE;
+            _model->pushState(GAME_WIN);
         }
-        resetPlayer();
     }
-    // Check win condition
-    if(_model->getState() == GAME_ACTIVE && _model->isCompleted()){//TODO:: very expensive check
-        resetLevel();
-        resetPlayer();
-        _effects->Chaos = GL_TRUE;
-        _model->pushState(GAME_WIN);
-    }
-}
-
-void Game::processInput(){
-    _model->processInput();
-}
-
-void Game::render(){
-    if (_model->getState() == GAME_ACTIVE || _model->getState() == GAME_MENU || _model->getState() == GAME_WIN){
-        // Begin rendering to postprocessing quad
-        _effects->beginRender();
-        
-        // Draw background
-        _renderer->drawSprite(ResourceManager::getTexture("background"),
-                              glm::vec2(0, 0),
-                              glm::vec2(_width, _height),
-                              0.0f);
-        // Draw level
-        _view->draw(*_renderer);
-        // Draw player
-        _player->draw(*_renderer);
-        // Draw PowerUps
-        for (PowerUp &powerUp : _powerUpsVector)
-            if (!powerUp._destroyed)
-                powerUp.draw(*_renderer);
+    publishSnapshot();
+}
+
+void Game::processInput(uint64_t time){
+    PROFILE_SCOPE("Game::processInput");
+    _inputApplied = Clock::now();
+    _model->processInput(time);
+}
+
+void Game::publishSnapshot(){
+    PROFILE_SCOPE("Game::publishSnapshot");
+    RenderSnapshot& frame = _snapshots.back();
+    frame.Tick = ++_tick;
+    frame.Time = _time;
+    frame.State = _model->getState();
+    frame.Lives = _lives;
+    frame.Chaos = _chaos;
+    frame.Confuse = _confuse;
+    frame.Shake = _shake;
+    if (frame.BoardVersion != _boardVersion){
+        frame.Board = _board;
+        frame.BoardVersion = _boardVersion;
+        frame.DestroyedBricks.clear();
+    }
+    // The buffer already holds the bricks destroyed up to when it was last published
+    frame.DestroyedBricks.insert(frame.DestroyedBricks.end(), _destroyedBricks.begin() + frame.DestroyedBricks.size(), _destroyedBricks.end());
+    frame.BricksRemaining = _bricksRemaining;
+    frame.Player = spriteOf(*_player);
+    frame.PowerUps.clear();
+    frame.LivePowerUps = 0;
+    frame.CollisionPairs = static_cast<int>(_collisions.lastTick().PairsTested);
+    frame.CollisionContacts = static_cast<int>(_collisions.lastTick().Contacts);
+    frame.SimulationScopes = _simulationScopes;
+    for (const PowerUp &powerUp : _powerUpsVector){
+        if (!powerUp._destroyed)
+            frame.PowerUps.push_back(spriteOf(powerUp));
+        if (!powerUp._destroyed || powerUp._activated)
+            ++frame.LivePowerUps;
+    }
+    _particles->collect(frame.Particles);
+    frame.Ball = spriteOf(*_ball);
+    frame.BallStuck = _ball->_stuck;
+    frame.OverlayToggles = _overlayToggles;
+    frame.AntiAliasingCycles = _antiAliasingCycles;
+    frame.BloomCycles = _bloomCycles;
+    frame.Input = _trace;
+    _snapshots.publish();
+}
+
+void Game::startSimulationThread(float step){
+    if (_simulationThread.joinable())
+        return;
+    _simulationRunning.store(true, std::memory_order_release);
+    _simulationThread = std::thread(&Game::simulationLoop, this, step);
+}
+
+void Game::stopSimulationThread(){
+    if (!_simulationThread.joinable())
+        return;
+    _simulationRunning.store(false, std::memory_order_release);
+    _simulationThread.join();
+}
+
+void Game::simulationLoop(float step){
+    Profiler::setThreadName("Simulation");
+    const uint64_t stepNs = static_cast<uint64_t>(step * 1e9);
+    uint64_t next = Clock::now();
+    while (_simulationRunning.load(std::memory_order_acquire)){
+        uint64_t start = Clock::now();
+        _tickLateness.add(start > next ? (start - next) / 1e6 : 0.0);
+        // The tick covers the input up to its scheduled time, later events go to the next one
+        processInput(next);
+        update(step);
+        Profiler::endFrame();
+        // The scopes are timed on this thread, so the overlay gets them through the next snapshot
+        if (Profiler::isStatsEnabled())
+            _simulationScopes = Profiler::lastFrameTotals();
+        else
+            _simulationScopes.clear();
+        next += stepNs;
+        // More than a tick behind (e.g. the process was descheduled): drop the backlog rather than spiral
+        uint64_t now = Clock::now();
+        if (now > next + stepNs)
+            next = now;
+        else
+            Clock::sleepUntil(next);
+    }
+}
+
+void Game::render(float dt){
+    PROFILE_SCOPE("Game::render");
+    // Draw the newest simulation tick (the same one again if the simulation hasn't ticked since)
+    _snapshots.update();
+    const RenderSnapshot& frame = _snapshots.front();
+    SpriteInstance player = frame.Player;
+    SpriteInstance ball = frame.Ball;
+    _frameTrace = frame.Input;
+    if (_latchInput)
+        lateLatch(frame, player, ball);
+    // After skipped frames dt spans the idle time, which says nothing about the cost of a frame
+    if (!_skippedFrames){
+        _overlay->addFrameTime(dt);
+        // Dynamic resolution: the next frame's scene scale follows the measured frame time
+        if (_resolutionScaler)
+            _effects->setScale(_resolutionScaler->update(dt * 1000.0f));
+    }
+    _skippedFrames = false;
+    // Debug keys pressed since the last snapshot drawn
+    for (; _overlayTogglesSeen != frame.OverlayToggles; ++_overlayTogglesSeen)
+        _overlay->toggle();
+    for (; _antiAliasingCyclesSeen != frame.AntiAliasingCycles; ++_antiAliasingCyclesSeen)
+        onCycleAntiAliasing();
+    for (; _bloomCyclesSeen != frame.BloomCycles; ++_bloomCyclesSeen)
+        onCycleBloom();
+    _effects->Chaos = frame.Chaos;
+    _effects->Confuse = frame.Confuse;
+    _effects->Shake = frame.Shake;
+    
+    _gpuProfiler->beginFrame();
+    if (frame.State == GAME_ACTIVE || frame.State == GAME_MENU || frame.State == GAME_WIN){
+        {
+            PROFILE_SCOPE("Render::scene");
+            GPU_PROFILE_SCOPE(*_gpuProfiler, "GPU scene");
+            // Remove the bricks destroyed since the last frame from the cached background and level
+            // (it draws into its own framebuffer, so before the scene's is bound)
+            {
+                PROFILE_SCOPE("BrickLayer::update");
+                static const std::vector<SpriteInstance> noBricks;
+                _brickLayer->update(*_renderer, ResourceManager::getTexture("background"), frame.Board ? *frame.Board : noBricks,
+                                    frame.BoardVersion, frame.DestroyedBricks);
+            }
+            // Begin rendering to postprocessing quad
+            _effects->beginRender();
+            // Draw background and level
+            {
+                PROFILE_SCOPE("BrickLayer::draw");
+                _brickLayer->draw(*_renderer);
+            }
+            // Draw player
+            _renderer->drawSprite(player);
+            // Draw PowerUps
+            for (const SpriteInstance &powerUp : frame.PowerUps)
+                _renderer->drawSprite(powerUp);
+        }
         // Draw particles
-        _particles->draw();
+        {
+            PROFILE_SCOPE("Particles::draw");
+            GPU_PROFILE_SCOPE(*_gpuProfiler, "GPU particles");
+            _particles->draw(frame.Particles);
+        }
         // Draw ball
-        _ball->draw(*_renderer);
+        {
+            GPU_PROFILE_SCOPE(*_gpuProfiler, "GPU ball");
+            _renderer->drawSprite(ball);
+        }
+        {
+            PROFILE_SCOPE("PostProcessor::endRender");
+            GPU_PROFILE_SCOPE(*_gpuProfiler, "GPU MSAA resolve");
+            // End rendering to postprocessing quad
+            _effects->endRender();
+        }
+        {
+            PROFILE_SCOPE("PostProcessor::render");
+            GPU_PROFILE_SCOPE(*_gpuProfiler, "GPU post-process");
+            // Render postprocessing quad
+            _effects->render(Clock::phase(frame.Time, Clock::EFFECT_PERIOD_NS));
+        }
+    }
+    // Render text (don't include in postprocessing)
+    {
+        PROFILE_SCOPE("Render::text");
+        GPU_PROFILE_SCOPE(*_gpuProfiler, "GPU text");
+        if (frame.State == GAME_ACTIVE || frame.State == GAME_MENU || frame.State == GAME_WIN){
+            std::string ss(std::to_string(frame.Lives));
+            _text->renderText("Lives:" + ss, 5.0f, 5.0f, 1.0f);
+        }
+        if (frame.State == GAME_MENU){
+            _text->renderText("Press ENTER to start", 250.0f, _height / 2, 1.0f);
+            _text->renderText("Press W or S to select level", 245.0f, _height / 2 + 20.0f, 0.75f);
+        }
+        if (frame.State == GAME_WIN){
+            _text->renderText("You WON!!!", 320.0f, _height / 2 - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+            _text->renderText("Press ENTER to retry or ESC to quit", 130.0f, _height / 2, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
+        }
+    }
+    // Performance overlay (F3)
+    if (_overlay->isVisible()){
+        GPU_PROFILE_SCOPE(*_gpuProfiler, "GPU overlay");
+        OverlayCounters counters;
+        counters.LiveParticles = static_cast<int>(frame.Particles.size());
+        counters.LivePowerUps = frame.LivePowerUps;
+        counters.BricksRemaining = frame.BricksRemaining;
+        counters.CollisionPairs = frame.CollisionPairs;
+        counters.CollisionContacts = frame.CollisionContacts;
+        counters.SimulationScopes = &frame.SimulationScopes;
+        counters.SceneScale = _effects->getScale();
+        _overlay->draw(*_renderer, *_text, counters);
+    }
+    _gpuProfiler->endFrame();
+    _frameTrace.Submitted = Clock::now();
+    // Idle screens remember what they drew, to skip drawing it again
+    _lastDrawnValid = frame.State == GAME_MENU || frame.State == GAME_WIN;
+    if (_lastDrawnValid)
+        _lastDrawn = frame;
+}
+
+bool Game::frameUnchanged(){
+    PROFILE_SCOPE("Game::frameUnchanged");
+    _snapshots.update();
+    const RenderSnapshot& frame = _snapshots.front();
+    // The overlay's graphs move every frame
+    if (!_lastDrawnValid || _overlay->isVisible() || !looksSame(frame, _lastDrawn))
+        return false;
+    _skippedFrames = true;
+    return true;
+}
 
-        
-        // End rendering to postprocessing quad
-        _effects->endRender();
-        // Render postprocessing quad
-        _effects->render(glfwGetTime());
-        // Render text (don't include in postprocessing)
-        std::string ss(std::to_string(_lives));
-        _text->renderText("Lives:" + ss, 5.0f, 5.0f, 1.0f);
+void Game::presented(){
+    // A press is traced once, by the first presented frame showing the paddle move it caused
+    if (_frameTrace.Event > _lastTracedEvent){
+        _frameTrace.Presented = Clock::now();
+        _inputLatency.add(_frameTrace);
+        _lastTracedEvent = _frameTrace.Event;
     }
-    if (_model->getState() == GAME_MENU){
-        _text->renderText("Press ENTER to start", 250.0f, _height / 2, 1.0f);
-        _text->renderText("Press W or S to select level", 245.0f, _height / 2 + 20.0f, 0.75f);
+}
+
+void Game::setLateLatching(bool enabled){
+    if (enabled && !_latchInput)
+        _latchInput = std::make_unique<InputManager>();
+    else if (!enabled)
+        _latchInput.reset();
+}
+
+void Game::lateLatch(const RenderSnapshot& frame, SpriteInstance& player, SpriteInstance& ball){
+    PROFILE_SCOPE("Game::lateLatch");
+    uint64_t now = Clock::now();
+    _latchInput->update(now);
+    if (frame.State != GAME_ACTIVE)
+        return;
+    // Same keys and steps as GameModel::processInput/onKeyPressed, applied to the drawn copies only:
+    // the simulation makes the real move on its next tick
+    const int keys[] = { GLFW_KEY_A, GLFW_KEY_D };
+    const Direction directions[] = { LEFT, RIGHT };
+    uint64_t pressed = 0;
+    for (int i = 0; i < 2; ++i){
+        if (!_latchInput->getIsKeyDown(keys[i]))
+            continue;
+        float step = paddleStep(player.Position.x, player.Size.x, _width, directions[i]);
+        if (step == 0.0f)
+            continue;
+        player.Position.x += step;
+        if (frame.BallStuck)
+            ball.Position.x += step;
+        pressed = std::max(pressed, _latchInput->getKeyPressTime(keys[i]));
     }
-    if (_model->getState() == GAME_WIN){
-        _text->renderText("You WON!!!", 320.0f, _height / 2 - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
-        _text->renderText("Press ENTER to retry or ESC to quit", 130.0f, _height / 2, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
+    if (pressed > _frameTrace.Event){
+        _frameTrace = InputTrace();
+        _frameTrace.Event = pressed;
+        _frameTrace.Applied = now;
+        _frameTrace.Moved = Clock::now();
     }
 }
 
+void Game::bricksChanged(){
+    _collisions.setBricks(_view->_bricksVector);
+    // A new board for the renderer's brick layer, in the same order as the collision stage's indices
+    auto board = std::make_shared<std::vector<SpriteInstance>>();
+    for (const auto& row : _view->_bricksVector)
+        for (const GameObject &brick : row)
+            board->push_back(spriteOf(brick));
+    _board = board;
+    ++_boardVersion;
+    _bricksRemaining = _view->bricksRemaining();
+    _destroyedBricks.clear();
+    for (uint32_t index = 0; index < board->size(); ++index)
+        if (_collisions.brick(index)._destroyed)
+            _destroyedBricks.push_back(index);
+}
+
 void Game::resetLevel(){
     _model->resetLevel();
 }
@@ -198,82 +487,83 @@ void Game::resetPlayer(){
     _player->_position = glm::vec2(_width / 2 - PLAYER_SIZE.x / 2, _height - PLAYER_SIZE.y);
     _ball->reset(_player->_position + glm::vec2(PLAYER_SIZE.x / 2 - BALL_RADIUS, -(BALL_RADIUS * 2)), INITIAL_BALL_VELOCITY);
     // Also disable all active powerups
-    _effects->Chaos = _effects->Confuse = GL_FALSE;
+    _chaos = _confuse = GL_FALSE;
     _ball->_passThrough = _ball->_sticky = GL_FALSE;
     _player->_color = glm::vec3(1.0f);
     _ball->_color = glm::vec3(1.0f);
 }
 
 void Game::doCollisions(){
-    for (auto& row : _view->_bricksVector) {
-        for (GameObject &box : row){
-            if (!box._destroyed){
-            //Ball - brick collisions
-            Collision collision = checkCollision(*_ball, box);
-            if (std::get<0>(collision)){ // If collision is true
-                // Destroy block if not solid or Passtrhough powerup not enabled
-                if (!(_ball->_passThrough && !box._isSolid)){
-                    box._destroyed = GL_TRUE;
-                    spawnPowerUps(box);
-                } else {   // if block is solid, enable shake effect
-                    _shakeTime = 0.05f;
-                    _effects->Shake = true;
-                }
-                // Collision resolution
-                Direction dir = std::get<1>(collision);
-                glm::vec2 diff_vector = std::get<2>(collision);
-                if (dir == LEFT || dir == RIGHT){ // Horizontal collision
-                    _ball->_velocity.x = -_ball->_velocity.x; // Reverse horizontal velocity
-                    // Relocate
-                    float penetration = _ball->_radius - std::abs(diff_vector.x);
-                    if (dir == LEFT){
-                        _ball->_position.x += penetration; // Move ball to right
-                    } else {
-                        _ball->_position.x -= penetration; // Move ball to left;
-                    }
-                } else { // Vertical collision
-                    _ball->_velocity.y = -_ball->_velocity.y; // Reverse vertical velocity
-                    // Relocate
-                    float penetration = _ball->_radius - std::abs(diff_vector.y);
-                    if (dir == UP){
-                        _ball->_position.y -= penetration; // Move ball back up
-                    } else {
-                        _ball->_position.y += penetration; // Move ball back down
-                    }
-                }
-            }
-            
-            //Player - ball collisions
-            Collision result = checkCollision(*_ball, *_player);
-            //The further the ball hits the paddle from its center,
-            //the stronger its horizontal velocity should be.
-            if (!_ball->_stuck && std::get<0>(result)){
-                // Check where it hit the board, and change velocity based on where it hit the board
-                float centerBoard = _player->_position.x + _player->_size.x / 2;
-                float distance = (_ball->_position.x + _ball->_radius) - centerBoard;
-                float percentage = distance / (_player->_size.x / 2);
-                // Then move accordingly
-                float strength = 2.0f;
-                glm::vec2 oldVelocity = _ball->_velocity;
-                _ball->_velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
-                //Ball->Velocity.y = -Ball->Velocity.y;
-                _ball->_velocity.y = -1 * abs(_ball->_velocity.y);//hack: assume we always have a collision at the top of the paddle
-
-                //new velocity vector is normalized and multiplied by the length of the old velocity vector.
-                //This way, the strength and thus the velocity of the ball is always consistent,
-                //regardless of where it hits the paddle.
-                _ball->_velocity = glm::normalize(_ball->_velocity) * glm::length(oldVelocity);
-                _ball->_stuck = _ball->_sticky;
+    // Ball - brick collisions: every contact of the tick is found first, deepest first, so the
+    // result does not depend on brick order
+    const std::vector<BrickContact>& contacts = _collisions.gather(*_ball);
+    bool bouncedX = false, bouncedY = false;
+    for (const BrickContact& contact : contacts){
+        GameObject& box = _collisions.brick(contact.Hit.Brick);
+        // Destroy block if not solid or Passtrhough powerup not enabled
+        if (!(_ball->_passThrough && !box._isSolid)){
+            box._destroyed = GL_TRUE;
+            _collisions.remove(contact.Hit.Brick);
+            _destroyedBricks.push_back(contact.Hit.Brick);
+            if (!box._isSolid)
+                --_bricksRemaining;
+            spawnPowerUps(box);
+        } else {   // if block is solid, enable shake effect
+            _shakeTime = 0.05f;
+            _shake = true;
+        }
+        // Collision resolution: the deepest contact on each axis moves the ball out and bounces it,
+        // the others (e.g. the next brick along a wall) are already resolved by that
+        Direction dir = contact.Hit.Dir;
+        if (dir == LEFT || dir == RIGHT){ // Horizontal collision
+            if (bouncedX)
+                continue;
+            bouncedX = true;
+            _ball->_velocity.x = -_ball->_velocity.x; // Reverse horizontal velocity
+            // Relocate
+            if (dir == LEFT){
+                _ball->_position.x += contact.Penetration; // Move ball to right
+            } else {
+                _ball->_position.x -= contact.Penetration; // Move ball to left;
             }
-            
-            //check if it hits Bottom Edge
-            if (_ball->_position.y >= _height){ // Did ball reach bottom edge?
-                resetLevel();
-                resetPlayer();
+        } else { // Vertical collision
+            if (bouncedY)
+                continue;
+            bouncedY = true;
+            _ball->_velocity.y = -_ball->_velocity.y; // Reverse vertical velocity
+            // Relocate
+            if (dir == UP){
+                _ball->_position.y -= contact.Penetration; // Move ball back up
+            } else {
+                _ball->_position.y += contact.Penetration; // Move ball back down
             }
         }
-        }
+        _collisions.resolved();
+    }
+
+    //Player - ball collisions
+    Collision result = checkCollision(*_ball, *_player);
+    //The further the ball hits the paddle from its center,
+    //the stronger its horizontal velocity should be.
+    if (!_ball->_stuck && std::get<0>(result)){
+        // Check where it hit the board, and change velocity based on where it hit the board
+        float centerBoard = _player->_position.x + _player->_size.x / 2;
+        float distance = (_ball->_position.x + _ball->_radius) - centerBoard;
+        float percentage = distance / (_player->_size.x / 2);
+        // Then move accordingly
+        float strength = 2.0f;
+        glm::vec2 oldVelocity = _ball->_velocity;
+        _ball->_velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+        //Ball->Velocity.y = -Ball->Velocity.y;
+        _ball->_velocity.y = -1 * abs(_ball->_velocity.y);//hack: assume we always have a collision at the top of the paddle
+
+        //new velocity vector is normalized and multiplied by the length of the old velocity vector.
+        //This way, the strength and thus the velocity of the ball is always consistent,
+        //regardless of where it hits the paddle.
+        _ball->_velocity = glm::normalize(_ball->_velocity) * glm::length(oldVelocity);
+        _ball->_stuck = _ball->_sticky;
     }
+
     for (PowerUp &powerUp : _powerUpsVector){
         if (!powerUp._destroyed){
             if (powerUp._position.y >= _height)
@@ -285,6 +575,18 @@ void Game::doCollisions(){
             }
         }
     }
+
+    // Check loss condition
+    if (_ball->_position.y >= _height){ // Did ball reach bottom edge?
+        --_lives;
+        // Did the player lose all his lives? : Game over
+        if (_lives == 0){
+            resetLevel();
+            _lives = INITIAL_LIVES;
+            _model->pushState(GAME_MENU);
+        }
+        resetPlayer();
+    }
 }
 
 void Game::spawnPowerUps(GameObject &block){//TODO: Review this.
@@ -329,11 +631,11 @@ void Game::updatePowerUps(float dt){
                     }
                 } else if (powerUp._type == "confuse"){
                     if (!isOtherPowerUpActive(_powerUpsVector, "confuse")){// Only reset if no other PowerUp of type confuse is active
-                        _effects->Confuse = GL_FALSE;
+                        _confuse = GL_FALSE;
                     }
                 } else if (powerUp._type == "chaos"){
                     if (!isOtherPowerUpActive(_powerUpsVector, "chaos")){// Only reset if no other PowerUp of type chaos is active
-                        _effects->Chaos = GL_FALSE;
+                        _chaos = GL_FALSE;
                     }
                 }
             }
@@ -358,16 +660,72 @@ void Game::activatePowerUp(PowerUp &powerUp){//TODO:Switch case
     } else if (powerUp._type == "pad-size-increase"){
         _player->_size.x += 50;
     } else if (powerUp._type == "confuse"){
-        if (!_effects->Chaos)
-            _effects->Confuse = GL_TRUE; // Only activate if chaos wasn't already active
+        if (!_chaos)
+            _confuse = GL_TRUE; // Only activate if chaos wasn't already active
     } else if (powerUp._type == "chaos"){
-        if (!_effects->Confuse)
-            _effects->Chaos = GL_TRUE;
+        if (!_confuse)
+            _chaos = GL_TRUE;
     }
 }
 
+void Game::setAntiAliasing(int samples, bool fxaa){
+    _msaaSamples = samples;
+    _fxaa = fxaa;
+    if (_effects){
+        _effects->setSamples(samples);
+        _effects->FXAA = fxaa;
+    }
+}
+
+void Game::setCrtEffect(bool enabled){
+    _crt = enabled;
+    if (_effects){
+        _effects->chain().find("grade")->Enabled = enabled;
+        _effects->chain().find("scanlines")->Enabled = enabled;
+    }
+}
+
+void Game::setBloomQuality(BloomQuality quality){
+    _bloomQuality = quality;
+    if (_bloom)
+        _bloom->setQuality(quality);
+}
+
+void Game::setDynamicResolution(float targetMs, float minScale, float maxScale){
+    if (targetMs > 0.0f)
+        _resolutionScaler = std::make_unique<ResolutionScaler>(targetMs, minScale, maxScale);
+    else
+        _resolutionScaler.reset();
+    if (_effects && !_resolutionScaler)
+        _effects->setScale(1.0f);
+}
+
+// Cycles bloom off -> low -> medium -> high
+void Game::onCycleBloom(){
+    BloomQuality next = _bloomQuality == BloomQuality::Off    ? BloomQuality::Low
+                      : _bloomQuality == BloomQuality::Low    ? BloomQuality::Medium
+                      : _bloomQuality == BloomQuality::Medium ? BloomQuality::High : BloomQuality::Off;
+    setBloomQuality(next);
+    std::cout << "Bloom: " << Bloom::qualityName(next) << std::endl;
+}
+
+// Cycles MSAA max -> 4x -> 2x -> FXAA only -> off, to compare quality and frame time live
+void Game::onCycleAntiAliasing(){
+    if (_fxaa)
+        setAntiAliasing(0, false);
+    else if (_msaaSamples == 0)
+        setAntiAliasing(-1, false);
+    else if (_msaaSamples < 0 || _msaaSamples > 4)
+        setAntiAliasing(4, false);
+    else if (_msaaSamples > 2)
+        setAntiAliasing(2, false);
+    else
+        setAntiAliasing(0, true);
+    std::cout << "Anti-aliasing: " << _effects->getSamples() << "x MSAA" << (_fxaa ? " + FXAA" : "") << std::endl;
+}
+
 void Game::OnChaosEffectTriggered(bool trigger){
-    _effects->Chaos = trigger;
+    _chaos = trigger;
 }
 
 void Game::OnBallStuck(bool trigger){
@@ -376,77 +734,23 @@ void Game::OnBallStuck(bool trigger){
 
 void Game::onKeyPressed(Direction dir){
     // Move playerboard
-    if(dir == LEFT){
-        if (_player->_position.x >= 0){
-            _player->_position.x -= PLAYER_VELOCITY;
-            if (_ball->_stuck)
-                _ball->_position.x -= PLAYER_VELOCITY;
-        }
-    }
-    if(dir == RIGHT){
-        if (_player->_position.x <= _width - _player->_size.x){
-            _player->_position.x += PLAYER_VELOCITY;
-            if (_ball->_stuck)
-                _ball->_position.x += PLAYER_VELOCITY;
-        }
+    float step = paddleStep(_player->_position.x, _player->_size.x, _width, dir);
+    if (step == 0.0f)
+        return;
+    _player->_position.x += step;
+    if (_ball->_stuck)
+        _ball->_position.x += step;
+    // Latency trace: the first move caused by a new key press
+    uint64_t pressed = _model->keyPressTime(dir);
+    if (pressed > _trace.Event){
+        _trace = InputTrace();
+        _trace.Event = pressed;
+        _trace.Applied = _inputApplied;
+        _trace.Moved = Clock::now();
     }
 }
 
 
-inline bool checkCollision(GameObject &one, GameObject &two){ // AABB - Rectangle collision
-    // Collision x-axis?
-    bool collisionX = one._position.x + one._size.x >= two._position.x &&
-        two._position.x + two._size.x >= one._position.x;
-    // Collision y-axis?
-    bool collisionY = one._position.y + one._size.y >= two._position.y &&
-        two._position.y + two._size.y >= one._position.y;
-    // Collision only if on both axes
-    return collisionX && collisionY;
-}
-
-inline Collision checkCollision(BallObject &one, GameObject &two){ // AABB - Circle collision
-    // Get center point circle first
-    glm::vec2 center(one._position + one._radius);
-    // Calculate AABB info (center, half-extents)
-    glm::vec2 aabb_half_extents(two._size.x / 2, two._size.y / 2);
-    glm::vec2 aabb_center(
-        two._position.x + aabb_half_extents.x,
-        two._position.y + aabb_half_extents.y
-    );
-    // Get difference vector between both centers
-    glm::vec2 difference = center - aabb_center;
-    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
-    // Add clamped value to AABB_center and we get the value of box closest to circle
-    glm::vec2 closest = aabb_center + clamped;
-    // Retrieve vector between center circle and closest point AABB and check if length <= radius
-    difference = closest - center;
-    if (glm::length(difference) <= one._radius){
-        return std::make_tuple(GL_TRUE, vectorDirection(difference), difference);
-    }else {
-        return std::make_tuple(GL_FALSE, UP, glm::vec2(0, 0));
-    }
-}
-
-// Calculates which direction a vector is facing (N,E,S or W)
-inline Direction vectorDirection(glm::vec2 target){
-    glm::vec2 compass[] = {
-        glm::vec2(0.0f, 1.0f),    // up
-        glm::vec2(1.0f, 0.0f),    // right
-        glm::vec2(0.0f, -1.0f),   // down
-        glm::vec2(-1.0f, 0.0f)    // left
-    };
-    float max = 0.0f;
-    GLuint best_match = -1;
-    for (GLuint i = 0; i < 4; i++){
-        float dot_product = glm::dot(glm::normalize(target), compass[i]);
-        if (dot_product > max){
-            max = dot_product;
-            best_match = i;
-        }
-    }
-    return static_cast<Direction>(best_match);
-}
-
 inline bool shouldSpawn(GLuint chance){
     GLuint random = rand() % chance;
     return random == 0;
@@ -461,3 +765,59 @@ inline bool isOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string typ
     }
     return GL_FALSE;
 }
+
+inline SpriteInstance spriteOf(const GameObject &object){
+    SpriteInstance sprite;
+    sprite.Sprite = object._sprite;
+    sprite.Position = object._position;
+    sprite.Size = object._size;
+    sprite.Rotation = object._rotation;
+    sprite.Color = object._color;
+    return sprite;
+}
+
+inline float paddleStep(float x, float paddleWidth, GLuint screenWidth, Direction dir){
+    if (dir == LEFT)
+        return x >= 0 ? -PLAYER_VELOCITY : 0.0f;
+    if (dir == RIGHT)
+        return x <= screenWidth - paddleWidth ? PLAYER_VELOCITY : 0.0f;
+    return 0.0f;
+}
+
+inline std::vector<std::vector<TileType>> tileTypesOf(const TileBoard &board){
+    std::vector<std::vector<TileType>> types;
+    types.reserve(board.size());
+    for (const std::vector<Tile> &row : board){
+        types.emplace_back();
+        types.back().reserve(row.size());
+        for (const Tile &tile : row)
+            types.back().push_back(tile.tileType);
+    }
+    return types;
+}
+
+inline bool sameSprite(const SpriteInstance &a, const SpriteInstance &b){
+    return a.Sprite.ID == b.Sprite.ID && a.Position == b.Position && a.Size == b.Size
+        && a.Rotation == b.Rotation && a.Color == b.Color;
+}
+
+inline bool sameSprites(const std::vector<SpriteInstance> &a, const std::vector<SpriteInstance> &b){
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), sameSprite);
+}
+
+inline bool looksSame(const RenderSnapshot &a, const RenderSnapshot &b){
+    if (a.State != b.State || a.Lives != b.Lives || a.Chaos != b.Chaos || a.Confuse != b.Confuse || a.Shake != b.Shake)
+        return false;
+    // Chaos and shake animate with the game time
+    if ((a.Chaos || a.Shake) && a.Time != b.Time)
+        return false;
+    // Pending debug keys change the rendering settings
+    if (a.OverlayToggles != b.OverlayToggles || a.AntiAliasingCycles != b.AntiAliasingCycles || a.BloomCycles != b.BloomCycles)
+        return false;
+    // Dead particles are not collected, so a settled screen has none
+    if (!a.Particles.empty() || !b.Particles.empty())
+        return false;
+    return sameSprite(a.Player, b.Player) && sameSprite(a.Ball, b.Ball)
+        && a.BoardVersion == b.BoardVersion && a.DestroyedBricks.size() == b.DestroyedBricks.size()
+        && sameSprites(a.PowerUps, b.PowerUps);
+}
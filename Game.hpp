@@ -17,27 +17,41 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <atomic>
+#include <thread>
+
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "ResourceManager.hpp"
 #include "SpriteRenderer.hpp"
 #include "ParticleGenerator.hpp"
 #include "PostProcessor.hpp"
+#include "Bloom.hpp"
+#include "ResolutionScaler.hpp"
 #include "PowerUp.hpp"
 #include "TextRenderer.hpp"
 #include "BallObject.hpp"
+#include "DebugOverlay.hpp"
+#include "BrickLayer.hpp"
+#include "GpuProfiler.hpp"
+#include "RunningStats.hpp"
+#include "LatencyRecorder.hpp"
+#include "TripleBuffer.hpp"
+#include "RenderSnapshot.hpp"
 
 #include "GameView.hpp"
 #include "GameModel.hpp"
+#include "Collision.hpp"
+#include "CollisionStage.hpp"
 
 
-
-// Defines a Collision typedef that represents collision data
-typedef std::tuple<bool, Direction, glm::vec2> Collision;
-
 // Game holds all game-related state and functionality.
 // Combines all game-related data into a single class for
 // easy access to each of the components and manageability.
+// The simulation (processInput/update) and the renderer only share
+// RenderSnapshots, published at the end of every update, so the
+// simulation can run on its own thread while the thread owning the GL
+// context renders whatever snapshot is newest.
 class Game{
 public:
     Game(GLuint width, GLuint height);
@@ -45,22 +59,70 @@ public:
     
     // Initialize game state (load all shaders/textures/levels)
     void init();
-    // GameLoop
-    void processInput();
+    // Plays level instead of the selected one, from a fresh paddle and ball. Call after init(), while
+    // the simulation is not running on its own thread
+    void loadLevel(const GameLevel& level);
+    // Attract mode: starts the game and keeps the paddle under the ball, which never stays stuck to it.
+    // Same restrictions as loadLevel()
+    void setAutoplay(bool enabled);
+    // GameLoop. Simulation side; processInput applies the input events up to time (Clock::now() clock):
+    void processInput(uint64_t time);
     void update(float dt);
-    void render();
+    // Render side (thread owning the GL context); dt is the time since the last rendered frame
+    void render(float dt);
+    // Call once the rendered frame has been presented (measures input latency)
+    void presented();
+    // Idle-frame skipping: whether the newest snapshot would draw exactly the frame drawn last. Only the
+    // menu and win screens are compared, once settled; the caller can then skip render() and leave the
+    // previous frame on screen
+    bool frameUnchanged();
+    // Makes the next frame draw even if unchanged (e.g. the window contents were damaged)
+    void invalidateFrame() { _lastDrawnValid = false; }
+    // Late latching: the renderer samples the keys again right before drawing and shows the
+    // paddle move the next tick will make, instead of waiting for the simulation to make it.
+    // Must be set on the main thread, before the simulation thread starts
+    void setLateLatching(bool enabled);
+    // Runs processInput/update every step seconds on a separate thread until stopSimulationThread()
+    void startSimulationThread(float step);
+    void stopSimulationThread();
+    bool isSimulationThreaded() const { return _simulationThread.joinable(); }
+    // Time between simulation ticks, in ms (read once the simulation has stopped)
+    const RunningStats& tickIntervals() const { return _tickIntervals; }
+    // How late simulation ticks started on their own thread, in ms
+    const RunningStats& tickLateness() const { return _tickLateness; }
+    // Key press to the first presented frame showing the paddle moving
+    const LatencyRecorder& inputLatency() const { return _inputLatency; }
+    // Ball - brick collision work since the game started (read once the simulation has stopped)
+    const CollisionCounters& collisionTotals() const { return _collisions.totals(); }
+    // Anti-aliasing: MSAA sample count (0 = off, negative = driver maximum) and/or FXAA.
+    // May be called before init()
+    void setAntiAliasing(int samples, bool fxaa);
+    // Arcade cabinet look (colour grading + CRT scanlines). May be called before init()
+    void setCrtEffect(bool enabled);
+    // Glow on bright objects. May be called before init()
+    void setBloomQuality(BloomQuality quality);
+    // Scales the scene's internal resolution within [minScale, maxScale] to hold
+    // targetMs per frame (0 turns it off). May be called before init()
+    void setDynamicResolution(float targetMs, float minScale, float maxScale);
     // Game state
 private:
     void doCollisions();
     void spawnPowerUps(GameObject &block);
     void updatePowerUps(float dt);
     void activatePowerUp(PowerUp &powerUp);
+    void publishSnapshot();
+    void lateLatch(const RenderSnapshot& frame, SpriteInstance& player, SpriteInstance& ball);
+    void simulationLoop(float step);
     void resetLevel();
     void resetPlayer();
+    // Rebuilds what is derived from the view's bricks: the collision arrays and the renderer's board
+    void bricksChanged();
     
     void OnChaosEffectTriggered(bool);
     void OnBallStuck(bool);
     void onKeyPressed(Direction);
+    void onCycleAntiAliasing();
+    void onCycleBloom();
     
     std::unique_ptr<GameView> _view;
     std::unique_ptr<GameModel> _model;
@@ -68,17 +130,67 @@ private:
     GLuint                  _width, _height;
 
     std::vector<PowerUp>    _powerUpsVector;
+    CollisionStage          _collisions;
+    // The bricks as the level was loaded, and the indices of those destroyed since (see RenderSnapshot)
+    std::shared_ptr<const std::vector<SpriteInstance>> _board;
+    uint32_t                _boardVersion = 0;
+    std::vector<uint32_t>   _destroyedBricks;
+    int                     _bricksRemaining = 0;
     GLuint                  _lives;
     // Game-related State data
-    SpriteRenderer      *_renderer;
+    SpriteRenderer      *_renderer = nullptr;
 
     std::unique_ptr<GameObject> _player;
     std::unique_ptr<BallObject> _ball;
-    ParticleGenerator   *_particles;
-    PostProcessor       *_effects;
-    TextRenderer        *_text;
+    ParticleGenerator   *_particles = nullptr;
+    PostProcessor       *_effects = nullptr;
+    TextRenderer        *_text = nullptr;
+    std::unique_ptr<Bloom>        _bloom;
+    std::unique_ptr<ResolutionScaler> _resolutionScaler;
+    std::unique_ptr<DebugOverlay> _overlay;
+    std::unique_ptr<BrickLayer>   _brickLayer;
+    std::unique_ptr<GpuProfiler>  _gpuProfiler;
     //Shake animation time
     float             _shakeTime = 0.0f;
+    // Game time in ns (drives the post-processing animations)
+    uint64_t          _time = 0;
+    // Post-processing effects, as decided by the simulation
+    bool              _chaos = false;
+    bool              _confuse = false;
+    bool              _shake = false;
+    // Debug key presses, handled by the renderer
+    uint32_t          _overlayToggles = 0;
+    uint32_t          _antiAliasingCycles = 0;
+    uint32_t          _bloomCycles = 0;
+    // Simulation -> renderer hand-off
+    TripleBuffer<RenderSnapshot> _snapshots;
+    uint64_t          _tick = 0;
+    uint64_t          _inputApplied = 0;
+    InputTrace        _trace;
+    uint64_t          _lastTickStart = 0;
+    RunningStats      _tickIntervals;
+    RunningStats      _tickLateness;
+    std::vector<ScopeTotal> _simulationScopes; // Last tick's, on the simulation thread
+    std::thread       _simulationThread;
+    std::atomic<bool> _simulationRunning{false};
+    // Renderer state: debug key presses already acted on, and input latency bookkeeping
+    uint32_t          _overlayTogglesSeen = 0;
+    uint32_t          _antiAliasingCyclesSeen = 0;
+    uint32_t          _bloomCyclesSeen = 0;
+    InputTrace        _frameTrace;
+    // Idle-frame skipping: the last frame drawn on an idle screen, and whether frames were skipped since
+    RenderSnapshot    _lastDrawn;
+    bool              _lastDrawnValid = false;
+    bool              _skippedFrames = false;
+    uint64_t          _lastTracedEvent = 0;
+    LatencyRecorder   _inputLatency;
+    std::unique_ptr<InputManager> _latchInput;
+    bool              _autoplay = false;
+    // Anti-aliasing configuration
+    int               _msaaSamples = -1;
+    bool              _fxaa = false;
+    bool              _crt = false;
+    BloomQuality      _bloomQuality = BloomQuality::Off;
     
 };
 
@@ -0,0 +1,68 @@
+//
+//  GameLevel.cpp
+//  Breakout Game
+//
+//  Created by Miguel Lopes on 22/11/2019.
+//  Copyright © 2019 Miguel Lopes. All rights reserved.
+//
+
+/*******************************************************************
+ ** This code is part of Breakout.
+ **
+ ** Breakout is free software: you can redistribute it and/or modify
+ ** it under the terms of the CC BY 4.0 license as published by
+ ** Creative Commons, either version 4 of the License, or (at your
+ ** option) any later version.
+ ******************************************************************/
+#include "GameLevel.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#include "ResourceManager.hpp"
+
+void GameLevel::load(const GLchar *file){
+    // Clear old data
+    _boardData.clear();
+    AssetView asset = ResourceManager::findAsset(file);
+    if (asset){
+        loadFromMemory(asset.c_str(), asset.Size);
+        return;
+    }
+    // Loose file fallback (development builds without an asset pack)
+    std::ifstream fstream(file, std::ios::binary);
+    if (fstream){
+        std::string contents((std::istreambuf_iterator<char>(fstream)), std::istreambuf_iterator<char>());
+        loadFromMemory(contents.data(), contents.size());
+    }
+}
+
+void GameLevel::loadFromMemory(const char *data, std::size_t size){
+    // Clear old data
+    _boardData.clear();
+    const char* cursor = data;
+    const char* end = data + size;
+    while (cursor < end){// Read each line from level data
+        const char* lineEnd = cursor;
+        while (lineEnd < end && *lineEnd != '\n')
+            ++lineEnd;
+        std::vector<GLuint> row;
+        // Read each number seperated by whitespace, stopping at the first non-numeric word
+        while (cursor < lineEnd){
+            if (*cursor == ' ' || *cursor == '\t' || *cursor == '\r'){
+                ++cursor;
+                continue;
+            }
+            if (*cursor < '0' || *cursor > '9')
+                break;
+            GLuint tileCode = 0;
+            while (cursor < lineEnd && *cursor >= '0' && *cursor <= '9')
+                tileCode = tileCode * 10 + static_cast<GLuint>(*cursor++ - '0');
+            row.push_back(tileCode);
+        }
+        _boardData.push_back(std::move(row));
+        cursor = lineEnd + 1;
+    }
+    if (_boardData.empty())
+        std::cout<<"Error: loading level isn't available"<<std::endl;
+}
@@ -22,8 +22,6 @@
 
 #include <string>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 
 /// GameLevel holds all Tiles as part of a Breakout level and
 /// hosts functionality to Load/render levels from the harddisk.
@@ -31,32 +29,10 @@ struct GameLevel{
 public:
     // Constructor
     GameLevel() = default;
-    // Loads level from file
-    void load(const GLchar *file){//TODO: move to imp file
-        // Clear old data
-        _boardData.clear();
-        // Load from file
-        GLuint tileCode;
-        GameLevel level;
-        std::string line;
-        std::ifstream fstream(file);
-        std::vector<std::vector<GLuint>> tileData;
-        if (fstream){
-            while (std::getline(fstream, line)) {// Read each line from level file
-                std::istringstream sstream(line);
-                std::vector<GLuint> row;
-                while (sstream >> tileCode) // Read each word seperated by spaces
-                    row.push_back(tileCode);
-                tileData.push_back(row);
-            }
-            if (tileData.size() > 0){
-                _boardData.reserve(tileData.size());
-                _boardData.insert(_boardData.end(), std::make_move_iterator(tileData.begin()),
-                std::make_move_iterator(tileData.end()));
-            }else{
-                std::cout<<"Error: loading level isn't available"<<std::endl;
-            }
-        }
-    }    // Initialize level from tile data
+    // Loads level from file (or from the mounted asset pack, if the level is packed)
+    void load(const GLchar *file);
+    // Loads level from an in-memory copy of a level file
+    void loadFromMemory(const char *data, std::size_t size);
+    // Initialize level from tile data
     std::vector<std::vector<GLuint>> _boardData;
 };
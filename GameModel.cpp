@@ -19,31 +19,36 @@ void GameModel::init(){
     _inputMgr = new InputManager();
 }
 
-void GameModel::processInput(){
+void GameModel::processInput(uint64_t time){
+    _inputMgr->update(time);
     int level = currentLevel();
+    // Debug keys work in every state: F3 toggles the overlay, F4 cycles anti-aliasing modes,
+    // F5 cycles bloom quality
+    if (_inputMgr->getIsKeyPressed(GLFW_KEY_F3) && _toggleOverlayCallback)
+        _toggleOverlayCallback();
+    if (_inputMgr->getIsKeyPressed(GLFW_KEY_F4) && _cycleAntiAliasingCallback)
+        _cycleAntiAliasingCallback();
+    if (_inputMgr->getIsKeyPressed(GLFW_KEY_F5) && _cycleBloomCallback)
+        _cycleBloomCallback();
     //TODO: switch case based on state
     if (_state == GAME_MENU){
-        if(_inputMgr->getIsKeyDown(GLFW_KEY_ENTER) && !_inputMgr->getLastKeyDown(GLFW_KEY_ENTER)){
+        if(_inputMgr->getIsKeyPressed(GLFW_KEY_ENTER)){
             _state = GAME_ACTIVE;
-            _inputMgr->setLastKeyDown(GLFW_KEY_ENTER, true);
         }
-        if(_inputMgr->getIsKeyDown(GLFW_KEY_W) && !_inputMgr->getLastKeyDown(GLFW_KEY_W)){
+        if(_inputMgr->getIsKeyPressed(GLFW_KEY_W)){
             _currentLevel = (level + 1) % 4;
-            _inputMgr->setLastKeyDown(GLFW_KEY_W, true);
         }
-        if(_inputMgr->getIsKeyDown(GLFW_KEY_S) && !_inputMgr->getLastKeyDown(GLFW_KEY_S)){
+        if(_inputMgr->getIsKeyPressed(GLFW_KEY_S)){
             if (_currentLevel > 0){
                 --_currentLevel;
             }else{
                 level = 3;
             }
-            _inputMgr->setLastKeyDown(GLFW_KEY_S, true);
         }
         setCurrentLevel(level);
     }
     if (_state == GAME_WIN){
-        if(_inputMgr->getIsKeyDown(GLFW_KEY_ENTER)){
-            _inputMgr->setLastKeyDown(GLFW_KEY_ENTER, true);
+        if(_inputMgr->getIsKeyPressed(GLFW_KEY_ENTER)){
             _toggleChaosEffectCallback(false);            
             _state = GAME_MENU;
         }
@@ -63,6 +68,10 @@ void GameModel::processInput(){
     }
 }
 
+uint64_t GameModel::keyPressTime(Direction dir) const{
+    return _inputMgr->getKeyPressTime(dir == LEFT ? GLFW_KEY_A : GLFW_KEY_D);
+}
+
 //TODO: refactor this, very bad. Keep a counter of living bricks and check if it's lower than 0.
 bool GameModel::isCompleted(){
     auto currentBoard = _boardTilesLevels[_currentLevel];
@@ -109,36 +118,45 @@ void GameModel::loadLevels(){
 }
 
 std::vector<TileBoard> GameModel::createBoardTiles(){
+    _boardTilesLevels.clear();
     _boardTilesLevels.reserve(_levelsVector.size());
     //For each level, check its data and create an entry of Tiles
-    for (int i = 0; i < _levelsVector.size(); ++i) {
-        auto currentLevel = _levelsVector[i];
-        int height = static_cast<int>(currentLevel._boardData.size());
-        int width = static_cast<int>(currentLevel._boardData[0].size()); // Note we can index vector at [0] since this function is only called if height > 0
-        
-        //Now create a board of tiles
-        _boardTiles.reserve(height);
-        std::vector<Tile> row;
-        for (int y = 0; y < height; ++y){
-            row.reserve(width);
-            for (int x = 0; x < width; ++x){
-                //create tile based on the level file data and push it to the boardTiles
-                Tile tile;
-                auto type = static_cast<TileType>(currentLevel._boardData[y][x]);
-                tile.tileType = type;
-                
-                if (type == TileType::solid) {
-                    tile.isSolid = true;
-                }
-                row.push_back(tile);
+    for (const GameLevel& level : _levelsVector)
+        _boardTilesLevels.emplace_back(tilesOf(level));
+    return _boardTilesLevels;
+}
+
+const TileBoard& GameModel::setLevel(const GameLevel& level){
+    _levelsVector[_currentLevel] = level;
+    _boardTilesLevels[_currentLevel] = tilesOf(level);
+    return _boardTilesLevels[_currentLevel];
+}
+
+TileBoard GameModel::tilesOf(const GameLevel& level){
+    int height = static_cast<int>(level._boardData.size());
+    int width = static_cast<int>(level._boardData[0].size()); // Note we can index vector at [0] since this function is only called if height > 0
+    
+    //Now create a board of tiles
+    TileBoard board;
+    board.reserve(height);
+    std::vector<Tile> row;
+    for (int y = 0; y < height; ++y){
+        row.reserve(width);
+        for (int x = 0; x < width; ++x){
+            //create tile based on the level file data and push it to the boardTiles
+            Tile tile;
+            auto type = static_cast<TileType>(level._boardData[y][x]);
+            tile.tileType = type;
+            
+            if (type == TileType::solid) {
+                tile.isSolid = true;
             }
-            _boardTiles.emplace_back(row);
-            row.clear();
+            row.push_back(tile);
         }
-        _boardTilesLevels.emplace_back(_boardTiles);
-        _boardTiles.clear();
+        board.emplace_back(row);
+        row.clear();
     }
-    return _boardTilesLevels;
+    return board;
 }
 
 void GameModel::toggleChaosEffect(ToggleChaosEffect handler){
@@ -152,3 +170,15 @@ void GameModel::toggleBallStuck(ToggleBallStuck handler){
 void GameModel::setKeyPressHandler(KeyPressed handler){
     _keyPressCallback = handler;
 }
+
+void GameModel::setToggleOverlayHandler(ToggleOverlay handler){
+    _toggleOverlayCallback = handler;
+}
+
+void GameModel::setCycleAntiAliasingHandler(CycleAntiAliasing handler){
+    _cycleAntiAliasingCallback = handler;
+}
+
+void GameModel::setCycleBloomHandler(CycleBloom handler){
+    _cycleBloomCallback = handler;
+}
@@ -41,6 +41,9 @@ typedef  std::vector<std::vector<Tile>> TileBoard;
 using ToggleChaosEffect = std::function<void(bool)>;
 using ToggleBallStuck   = std::function<void(bool)>;
 using KeyPressed        = std::function<void(Direction)>;
+using ToggleOverlay     = std::function<void()>;
+using CycleAntiAliasing = std::function<void()>;
+using CycleBloom        = std::function<void()>;
 
 class GameModel {
 
@@ -49,30 +52,40 @@ public:
     ~GameModel() = default;
     
     void init();
-    void processInput();
+    // Applies the input events up to time (Clock::now() clock) and reacts to them
+    void processInput(uint64_t time);
+    // Time of the newest input event processed so far
+    uint64_t lastInputTime() const { return _inputMgr->lastEventTime(); }
+    // Time of the key press that started the current paddle move in dir
+    uint64_t keyPressTime(Direction dir) const;
 
     // Check if the level is completed (all non-solid tiles are destroyed)
     bool isCompleted();
     
     //Returns a vector of all loaded levels
     std::vector<TileBoard> createBoardTiles();
+    // Replaces the current level (e.g. with a generated one) and returns its tiles
+    const TileBoard& setLevel(const GameLevel& level);
     void resetLevel();
     int currentLevel(){return _currentLevel;}
     void setCurrentLevel(int level){_currentLevel = level;}
     
-    void pushState(GameState state){state = _state;}
+    void pushState(GameState state){_state = state;}
     GameState getState() const {return _state;}
     
     //Register listeners
     void toggleChaosEffect(ToggleChaosEffect handler);
     void toggleBallStuck(ToggleBallStuck handler);
     void setKeyPressHandler(KeyPressed handler);
+    void setToggleOverlayHandler(ToggleOverlay handler);
+    void setCycleAntiAliasingHandler(CycleAntiAliasing handler);
+    void setCycleBloomHandler(CycleBloom handler);
 private:
     void loadLevels();
+    static TileBoard tilesOf(const GameLevel& level);
     
 
     std::vector<GameLevel>  _levelsVector;
-    TileBoard _boardTiles;
     std::vector<TileBoard> _boardTilesLevels; //tileBoards per level
     GameLevel* _Level;
     
@@ -83,7 +96,6 @@ private:
     int _height = 0;
     int _lives = 0;
     int _currentLevel = 0;
-    bool _KeysProcessed[1024];
     
     InputManager* _inputMgr;
     
@@ -91,4 +103,7 @@ private:
     ToggleChaosEffect _toggleChaosEffectCallback;
     ToggleBallStuck     _toggleBallStuck;
     KeyPressed          _keyPressCallback;
+    ToggleOverlay       _toggleOverlayCallback;
+    CycleAntiAliasing   _cycleAntiAliasingCallback;
+    CycleBloom          _cycleBloomCallback;
 };
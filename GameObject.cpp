@@ -31,7 +31,7 @@ GameObject::GameObject()
 
 GameObject::GameObject(glm::vec2 pos,
                        glm::vec2 size,
-                       Texture2D&& sprite,
+                       TextureView sprite,
                        glm::vec3 color,
                        glm::vec2 velocity)
                                             : _position(pos),
@@ -46,5 +46,5 @@ GameObject::GameObject(glm::vec2 pos,
 }
 
 void GameObject::draw(SpriteRenderer& renderer){
-    renderer.drawSprite(std::move(_sprite), _position, _size, _rotation, _color);
+    renderer.drawSprite(_sprite, _position, _size, _rotation, _color);
 }
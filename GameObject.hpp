@@ -31,7 +31,7 @@ public:
     GameObject();
     GameObject(glm::vec2 pos,
                glm::vec2 size,
-               Texture2D&& sprite,
+               TextureView sprite,
                glm::vec3 color = glm::vec3(1.0f),
                glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
     GameObject(const GameObject& obj) = default;
@@ -49,5 +49,5 @@ public:
     bool   _isSolid;
     bool   _destroyed;
     // Render state
-    Texture2D   _sprite;
+    TextureView _sprite; // non-owning, textures are owned by the ResourceManager
 };
@@ -18,7 +18,6 @@ void GameView::init(std::vector<std::vector<TileType>> tileBoard){
     // Load shaders
     ResourceManager::loadShader("Resources/shaders/sprite.vs", "Resources/shaders/sprite.frag", nullptr, "sprite");
     ResourceManager::loadShader("Resources/shaders/particle.vs", "Resources/shaders/particle.frag", nullptr, "particle");
-    ResourceManager::loadShader("Resources/shaders/post_processing.vs", "Resources/shaders/post_processing.frag", nullptr, "postprocessing");
 
     // Configure shaders
     glm::mat4 projection = glm::ortho(0.0f,static_cast<float>(_width),static_cast<float>(_height),0.0f, -1.0f, 1.0f);
@@ -49,7 +48,8 @@ void GameView::initLevel(std::vector<std::vector<TileType>> tileBoard){
     int yTiles =  static_cast<int>(tileBoard.size());
     int xTiles =  static_cast<int>(tileBoard[0].size());
     
-    float unit_width = static_cast<float>(_width/xTiles);
+    // Boards wider or taller than the screen get bricks smaller than a pixel
+    float unit_width = static_cast<float>(_width) / xTiles;
     float unit_height = static_cast<float>(_height*0.5/yTiles); //multiply by .5 to ocuppy half the screen
     
     _bricksVector.reserve(yTiles);
@@ -86,11 +86,25 @@ void GameView::initLevel(std::vector<std::vector<TileType>> tileBoard){
     }
 }
 
+void GameView::loadLevel(std::vector<std::vector<TileType>> tileBoard){
+    reloadLevel();
+    initLevel(tileBoard);
+}
+
 void GameView::reloadLevel(){
     // Clear old data
     _bricksVector.clear();
 }
 
+int GameView::bricksRemaining() const{
+    int count = 0;
+    for (const auto& vec : _bricksVector)
+        for (const auto& tile : vec)
+            if (!tile._destroyed && !tile._isSolid)
+                ++count;
+    return count;
+}
+
 void GameView::draw(SpriteRenderer &renderer){
     //render level
     for ( auto& vec : _bricksVector ){
@@ -21,7 +21,11 @@ public:
     ~GameView() = default;
     
     void init(std::vector<std::vector<TileType>> tileBoard);
+    // Replaces the bricks with those of another board
+    void loadLevel(std::vector<std::vector<TileType>> tileBoard);
     void draw(SpriteRenderer &renderer);
+    // Number of destructible bricks not yet destroyed
+    int bricksRemaining() const;
 
 public:
     // Level state
@@ -0,0 +1,233 @@
+//
+//  Narrowphase.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "Narrowphase.hpp"
+
+#include <algorithm>
+
+// The SIMD kernels are built for x86 with GCC/clang (the AVX2 one through a target attribute, picked
+// at run time); anywhere else every kernel falls back to the scalar one
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__SSE2__))
+#define NARROWPHASE_X86 1
+#include <immintrin.h>
+#else
+#define NARROWPHASE_X86 0
+#endif
+
+namespace {
+    // Out of reach of any ball, while its squared distance stays finite
+    const float PARKED = 1e18f;
+
+    void push(std::vector<Contact>& contacts, std::size_t brick, float dx, float dy, float dir){
+        Contact contact;
+        contact.Brick = static_cast<uint32_t>(brick);
+        contact.Dir = static_cast<Direction>(static_cast<int>(dir));
+        contact.Difference = glm::vec2(dx, dy);
+        contacts.push_back(contact);
+    }
+
+    COLLISION_NO_FP_CONTRACT
+    void collideScalar(float centerX, float centerY, float radius, const BrickSoA& bricks, std::size_t begin, std::size_t end,
+                       std::vector<Contact>& contacts){
+        for (std::size_t i = begin; i < end; ++i){
+            glm::vec2 difference;
+            if (circleBoxContact(centerX, centerY, radius, bricks.CenterX[i], bricks.CenterY[i],
+                                 bricks.HalfWidth[i], bricks.HalfHeight[i], difference)){
+                Contact contact;
+                contact.Brick = static_cast<uint32_t>(i);
+                contact.Dir = vectorDirection(difference);
+                contact.Difference = difference;
+                contacts.push_back(contact);
+            }
+        }
+    }
+
+#if NARROWPHASE_X86
+    // Each kernel repeats circleBoxContact and vectorDirection operation for operation. glm::clamp
+    // keeps the value on ties and max/min_ps return their second operand on ties, hence the operand
+    // order; negating flips the sign bit like the scalar minus does. Like circleBoxContact they are
+    // COLLISION_NO_FP_CONTRACT, or GCC fuses the mul_ps and add_ps into an FMA on FMA targets
+
+    inline __m128 blend(__m128 a, __m128 b, __m128 mask){
+        return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+    }
+
+    COLLISION_NO_FP_CONTRACT
+    void collideSSE(float centerX, float centerY, float radius, const BrickSoA& bricks, std::size_t begin, std::size_t end,
+                    std::vector<Contact>& contacts){
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        const __m128 cx = _mm_set1_ps(centerX);
+        const __m128 cy = _mm_set1_ps(centerY);
+        const __m128 r2 = _mm_set1_ps(radius * radius);
+        alignas(16) float dx[4], dy[4], dir[4];
+        for (std::size_t i = begin; i < end; i += 4){
+            __m128 bx = _mm_loadu_ps(&bricks.CenterX[i]);
+            __m128 by = _mm_loadu_ps(&bricks.CenterY[i]);
+            __m128 hw = _mm_loadu_ps(&bricks.HalfWidth[i]);
+            __m128 hh = _mm_loadu_ps(&bricks.HalfHeight[i]);
+            __m128 clampedX = _mm_min_ps(hw, _mm_max_ps(_mm_xor_ps(hw, sign), _mm_sub_ps(cx, bx)));
+            __m128 clampedY = _mm_min_ps(hh, _mm_max_ps(_mm_xor_ps(hh, sign), _mm_sub_ps(cy, by)));
+            __m128 diffX = _mm_sub_ps(_mm_add_ps(bx, clampedX), cx);
+            __m128 diffY = _mm_sub_ps(_mm_add_ps(by, clampedY), cy);
+            __m128 distance2 = _mm_add_ps(_mm_mul_ps(diffX, diffX), _mm_mul_ps(diffY, diffY));
+            int hits = _mm_movemask_ps(_mm_cmple_ps(distance2, r2));
+            if (!hits)
+                continue;
+            // Largest positive of up, right, down, left, the first one on ties
+            const __m128 candidates[4] = { diffY, diffX, _mm_xor_ps(diffY, sign), _mm_xor_ps(diffX, sign) };
+            __m128 max = _mm_setzero_ps();
+            __m128 best = _mm_set1_ps(static_cast<float>(DOWN));
+            for (int d = 0; d < 4; ++d){
+                __m128 greater = _mm_cmpgt_ps(candidates[d], max);
+                max = blend(max, candidates[d], greater);
+                best = blend(best, _mm_set1_ps(static_cast<float>(d)), greater);
+            }
+            _mm_store_ps(dx, diffX);
+            _mm_store_ps(dy, diffY);
+            _mm_store_ps(dir, best);
+            for (int lane = 0; lane < 4; ++lane)
+                if (hits & (1 << lane))
+                    push(contacts, i + lane, dx[lane], dy[lane], dir[lane]);
+        }
+    }
+
+    COLLISION_NO_FP_CONTRACT __attribute__((target("avx2")))
+    void collideAVX2(float centerX, float centerY, float radius, const BrickSoA& bricks, std::size_t begin, std::size_t end,
+                      std::vector<Contact>& contacts){
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+        const __m256 cx = _mm256_set1_ps(centerX);
+        const __m256 cy = _mm256_set1_ps(centerY);
+        const __m256 r2 = _mm256_set1_ps(radius * radius);
+        alignas(32) float dx[8], dy[8], dir[8];
+        for (std::size_t i = begin; i < end; i += 8){
+            __m256 bx = _mm256_loadu_ps(&bricks.CenterX[i]);
+            __m256 by = _mm256_loadu_ps(&bricks.CenterY[i]);
+            __m256 hw = _mm256_loadu_ps(&bricks.HalfWidth[i]);
+            __m256 hh = _mm256_loadu_ps(&bricks.HalfHeight[i]);
+            __m256 clampedX = _mm256_min_ps(hw, _mm256_max_ps(_mm256_xor_ps(hw, sign), _mm256_sub_ps(cx, bx)));
+            __m256 clampedY = _mm256_min_ps(hh, _mm256_max_ps(_mm256_xor_ps(hh, sign), _mm256_sub_ps(cy, by)));
+            __m256 diffX = _mm256_sub_ps(_mm256_add_ps(bx, clampedX), cx);
+            __m256 diffY = _mm256_sub_ps(_mm256_add_ps(by, clampedY), cy);
+            __m256 distance2 = _mm256_add_ps(_mm256_mul_ps(diffX, diffX), _mm256_mul_ps(diffY, diffY));
+            int hits = _mm256_movemask_ps(_mm256_cmp_ps(distance2, r2, _CMP_LE_OQ));
+            if (!hits)
+                continue;
+            const __m256 candidates[4] = { diffY, diffX, _mm256_xor_ps(diffY, sign), _mm256_xor_ps(diffX, sign) };
+            __m256 max = _mm256_setzero_ps();
+            __m256 best = _mm256_set1_ps(static_cast<float>(DOWN));
+            for (int d = 0; d < 4; ++d){
+                __m256 greater = _mm256_cmp_ps(candidates[d], max, _CMP_GT_OQ);
+                max = _mm256_blendv_ps(max, candidates[d], greater);
+                best = _mm256_blendv_ps(best, _mm256_set1_ps(static_cast<float>(d)), greater);
+            }
+            _mm256_store_ps(dx, diffX);
+            _mm256_store_ps(dy, diffY);
+            _mm256_store_ps(dir, best);
+            for (int lane = 0; lane < 8; ++lane)
+                if (hits & (1 << lane))
+                    push(contacts, i + lane, dx[lane], dy[lane], dir[lane]);
+        }
+    }
+#endif
+}
+
+void BrickSoA::assign(const std::vector<std::vector<GameObject>>& rows){
+    _count = 0;
+    for (const auto& row : rows)
+        _count += row.size();
+    std::size_t padded = (_count + BATCH - 1) / BATCH * BATCH;
+    CenterX.assign(padded, PARKED);
+    CenterY.assign(padded, PARKED);
+    HalfWidth.assign(padded, 0.0f);
+    HalfHeight.assign(padded, 0.0f);
+    std::size_t index = 0;
+    for (const auto& row : rows)
+        for (const GameObject& brick : row)
+            set(index++, brick);
+}
+
+void BrickSoA::set(std::size_t index, const GameObject& brick){
+    if (brick._destroyed){
+        park(index);
+        return;
+    }
+    // Computed as checkCollision does
+    HalfWidth[index] = brick._size.x / 2;
+    HalfHeight[index] = brick._size.y / 2;
+    CenterX[index] = brick._position.x + HalfWidth[index];
+    CenterY[index] = brick._position.y + HalfHeight[index];
+}
+
+void BrickSoA::park(std::size_t index){
+    CenterX[index] = PARKED;
+    CenterY[index] = PARKED;
+    HalfWidth[index] = 0.0f;
+    HalfHeight[index] = 0.0f;
+}
+
+std::size_t Narrowphase::collide(const BallObject& ball, const BrickSoA& bricks, std::vector<Contact>& contacts, NarrowphaseKernel kernel){
+    return collide(ball, bricks, 0, bricks.count(), contacts, kernel);
+}
+
+std::size_t Narrowphase::collide(const BallObject& ball, const BrickSoA& bricks, std::size_t begin, std::size_t end,
+                                 std::vector<Contact>& contacts, NarrowphaseKernel kernel){
+    glm::vec2 center(ball._position + ball._radius);
+    end = std::min(end, bricks.count());
+    if (begin >= end)
+        return 0;
+    if (!isSupported(kernel))
+        kernel = NarrowphaseKernel::Scalar;
+    // Whole batches: the arrays are padded to BATCH, and the extra bricks are tested like any other
+    std::size_t width = kernel == NarrowphaseKernel::AVX2 ? 8 : kernel == NarrowphaseKernel::SSE ? 4 : 1;
+    begin = begin / width * width;
+    end = (end + width - 1) / width * width;
+    switch (kernel){
+#if NARROWPHASE_X86
+        case NarrowphaseKernel::AVX2:
+            collideAVX2(center.x, center.y, ball._radius, bricks, begin, end, contacts);
+            break;
+        case NarrowphaseKernel::SSE:
+            collideSSE(center.x, center.y, ball._radius, bricks, begin, end, contacts);
+            break;
+#endif
+        default:
+            collideScalar(center.x, center.y, ball._radius, bricks, begin, end, contacts);
+            break;
+    }
+    return end - begin;
+}
+
+NarrowphaseKernel Narrowphase::best(){
+    static const NarrowphaseKernel kernel = isSupported(NarrowphaseKernel::AVX2) ? NarrowphaseKernel::AVX2
+                                          : isSupported(NarrowphaseKernel::SSE) ? NarrowphaseKernel::SSE
+                                          : NarrowphaseKernel::Scalar;
+    return kernel;
+}
+
+bool Narrowphase::isSupported(NarrowphaseKernel kernel){
+    switch (kernel){
+        case NarrowphaseKernel::Scalar:
+            return true;
+#if NARROWPHASE_X86
+        case NarrowphaseKernel::SSE:
+            return true;
+        case NarrowphaseKernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* Narrowphase::kernelName(NarrowphaseKernel kernel){
+    switch (kernel){
+        case NarrowphaseKernel::Scalar: return "scalar";
+        case NarrowphaseKernel::SSE:    return "sse";
+        case NarrowphaseKernel::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
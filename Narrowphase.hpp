@@ -0,0 +1,71 @@
+//
+//  Narrowphase.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Collision.hpp"
+
+// The bricks of a level as structure-of-arrays, the layout the batched
+// kernels load 4 or 8 bricks at a time from. Bricks keep the order of the
+// rows they were assigned from; destroyed ones are parked out of reach of
+// any ball, so the kernels need no per-brick liveness test. The arrays are
+// padded with parked bricks to a multiple of the widest batch.
+struct BrickSoA {
+    // Widest batch, what the arrays are padded to
+    static const std::size_t BATCH = 8;
+
+    std::vector<float> CenterX, CenterY;
+    std::vector<float> HalfWidth, HalfHeight;
+
+    // Replaces the bricks with those of the rows, in row-major order
+    void assign(const std::vector<std::vector<GameObject>>& rows);
+    // Takes brick index out of every later test
+    void park(std::size_t index);
+    // Number of bricks assigned (without the padding)
+    std::size_t count() const { return _count; }
+private:
+    void set(std::size_t index, const GameObject& brick);
+    std::size_t _count = 0;
+};
+
+// A ball touching a brick
+struct Contact {
+    uint32_t  Brick;      // Index in the BrickSoA
+    Direction Dir;        // As vectorDirection(Difference)
+    glm::vec2 Difference; // From the ball's centre to the closest point of the brick
+};
+
+// The instruction set a batch test runs on
+enum class NarrowphaseKernel {
+    Scalar, // One brick at a time, circleBoxContact itself
+    SSE,    // 4 bricks at a time
+    AVX2    // 8 bricks at a time
+};
+
+// Narrowphase tests one ball against a whole BrickSoA. Every kernel gives
+// exactly the contacts checkCollision(ball, brick) would, in brick order.
+class Narrowphase{
+public:
+    // Appends the ball's contacts with the bricks to contacts; returns the number of pairs tested
+    static std::size_t collide(const BallObject& ball, const BrickSoA& bricks, std::vector<Contact>& contacts,
+                               NarrowphaseKernel kernel = best());
+    // Same, for bricks [begin, end) only; the SIMD kernels widen the range to whole batches
+    static std::size_t collide(const BallObject& ball, const BrickSoA& bricks, std::size_t begin, std::size_t end,
+                               std::vector<Contact>& contacts, NarrowphaseKernel kernel = best());
+    // The fastest kernel this CPU runs
+    static NarrowphaseKernel best();
+    static bool isSupported(NarrowphaseKernel kernel);
+    static const char* kernelName(NarrowphaseKernel kernel);
+private:
+    Narrowphase() { }
+};
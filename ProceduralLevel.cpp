@@ -0,0 +1,69 @@
+//
+//  ProceduralLevel.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "ProceduralLevel.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace {
+    const GLuint BLANK = 0;
+    const GLuint SOLID = 1;
+    const GLuint FIRST_COLOR = 2;
+    const int MAX_COLORS = 4;
+
+    // Uniform in [0, 1) from the top 24 bits (what a float holds exactly)
+    float uniform(std::mt19937& rng){
+        return (rng() >> 8) * (1.0f / 16777216.0f);
+    }
+}
+
+GameLevel ProceduralLevel::generate(const LevelSpec& spec){
+    GameLevel level;
+    if (spec.Width <= 0 || spec.Height <= 0){
+        std::cout << "ERROR::PROCEDURALLEVEL: Invalid level size " << spec.Width << "x" << spec.Height << std::endl;
+        return level;
+    }
+    int colors = std::max(1, std::min(spec.Colors, MAX_COLORS));
+    std::mt19937 rng(spec.Seed);
+    level._boardData.assign(spec.Height, std::vector<GLuint>(spec.Width, BLANK));
+    for (int y = 0; y < spec.Height; ++y){
+        // Colour bands from top to bottom, like the hand-made levels
+        GLuint color = FIRST_COLOR + static_cast<GLuint>(static_cast<long long>(y) * colors / spec.Height);
+        for (GLuint& tile : level._boardData[y]){
+            if (uniform(rng) >= spec.Density)
+                continue;
+            tile = uniform(rng) < spec.SolidRatio ? SOLID : color;
+        }
+    }
+    return level;
+}
+
+std::string ProceduralLevel::toText(const GameLevel& level){
+    std::string text;
+    for (const std::vector<GLuint>& row : level._boardData){
+        for (std::size_t x = 0; x < row.size(); ++x){
+            if (x > 0)
+                text += ' ';
+            text += std::to_string(row[x]);
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+bool ProceduralLevel::write(const GameLevel& level, const std::string& file){
+    std::ofstream out(file, std::ios::binary);
+    std::string text = toText(level);
+    if (!out || !out.write(text.data(), text.size())){
+        std::cout << "ERROR::PROCEDURALLEVEL: Failed to write " << file << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,39 @@
+//
+//  ProceduralLevel.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "GameLevel.hpp"
+
+// What to generate. Tile codes are the .lvl ones: 0 blank, 1 solid, 2-5 colours
+struct LevelSpec {
+    int      Width = 15;         // Tiles per row
+    int      Height = 8;         // Rows
+    float    Density = 1.0f;     // Fraction of the tiles that hold a brick
+    float    SolidRatio = 0.1f;  // Fraction of the bricks that are solid (indestructible)
+    int      Colors = 4;         // Brick colours used, 1-4, in horizontal bands
+    uint32_t Seed = 1;           // The same spec and seed always give the same level
+};
+
+// ProceduralLevel generates levels of any size and density, for stress
+// tests and benchmarks (the hand-made levels are all 15x8). The output is
+// an ordinary GameLevel and is written in the .lvl format, so generated
+// levels load like the hand-made ones. Generation only uses the raw output
+// of std::mt19937, which the standard fixes, so a seed gives the same level
+// on every platform.
+class ProceduralLevel{
+public:
+    static GameLevel generate(const LevelSpec& spec);
+    // The level as .lvl text: one row per line, tile codes separated by spaces
+    static std::string toText(const GameLevel& level);
+    static bool write(const GameLevel& level, const std::string& file);
+private:
+    ProceduralLevel() { }
+};
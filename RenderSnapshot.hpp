@@ -0,0 +1,62 @@
+//
+//  RenderSnapshot.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "SpriteRenderer.hpp"
+#include "ParticleGenerator.hpp"
+#include "GameModel.hpp"
+#include "LatencyRecorder.hpp"
+#include "Profiler.hpp"
+
+// Everything the renderer needs to draw one simulation tick. The
+// simulation fills one at the end of every tick and publishes it through
+// a TripleBuffer; the renderer only ever reads snapshots, never the live
+// game objects, so the two can run on different threads.
+struct RenderSnapshot {
+    uint64_t  Tick = 0;        // Simulation tick that produced it
+    uint64_t  Time = 0;        // Game time in ns (drives the post-processing animations)
+    GameState State = GAME_MENU;
+    GLuint    Lives = 0;
+    // Post-processing effects
+    bool      Chaos = false;
+    bool      Confuse = false;
+    bool      Shake = false;
+    // The bricks as the level was loaded, shared by every snapshot until the next level (which bumps
+    // BoardVersion), and the indices of those destroyed since, oldest first. The renderer keeps them
+    // drawn in a BrickLayer and only redraws what the new indices take out
+    std::shared_ptr<const std::vector<SpriteInstance>> Board;
+    uint32_t  BoardVersion = 0;
+    std::vector<uint32_t> DestroyedBricks;
+    // Live objects, in draw order
+    SpriteInstance Player;
+    std::vector<SpriteInstance> PowerUps;
+    std::vector<Particle> Particles;
+    SpriteInstance Ball;
+    bool      BallStuck = true; // Moves with the paddle
+    // HUD/overlay counters
+    int       BricksRemaining = 0;
+    int       LivePowerUps = 0; // Falling or active
+    int       CollisionPairs = 0;    // Ball - brick pairs tested in the tick
+    int       CollisionContacts = 0; // and found touching
+    // Profiler scope totals of the previous tick when the simulation runs on its own thread
+    // (otherwise they are in the render thread's totals), while the overlay is shown
+    std::vector<ScopeTotal> SimulationScopes;
+    // Debug key presses so far. Snapshots can be skipped, so the renderer
+    // acts on the difference with the last counts it has seen
+    uint32_t  OverlayToggles = 0;
+    uint32_t  AntiAliasingCycles = 0;
+    uint32_t  BloomCycles = 0;
+    // The newest key press that moved the paddle, up to the tick
+    InputTrace Input;
+};
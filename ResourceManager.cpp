@@ -21,47 +21,85 @@
 #include <fstream>
 
 #include "SOIL.h"
+#include "Profiler.hpp"
 
 // Instantiate static variables
 std::map<std::string, Texture2D>    ResourceManager::_texturesMap;
 std::map<std::string, Shader>       ResourceManager::_shadersMap;
+std::map<std::string, GLProgram>    ResourceManager::_programsMap;
+AssetPack                           ResourceManager::_assetPack;
 
 
 Shader ResourceManager::loadShader(const GLchar *vShaderFile,
                                    const GLchar *fShaderFile,
                                    const GLchar *gShaderFile,
                                    const std::string& name){
-    _shadersMap[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-    return _shadersMap[name];
+    PROFILE_SCOPE("ResourceManager::loadShader");
+    Shader shader = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
+    // Take ownership of the program; reloading a name deletes the old program
+    _programsMap[name] = GLProgram(shader.ID);
+    _shadersMap[name] = shader;
+    return shader;
 }
 
 Shader ResourceManager::getShader(const std::string& name){
-    return _shadersMap[name];
+    auto it = _shadersMap.find(name);
+    return it != _shadersMap.end() ? it->second : Shader();
 }
 
-Texture2D ResourceManager::loadTexture(const GLchar *file,
-                                       bool alpha,
-                                       const std::string& name){
-    _texturesMap[name] = loadTextureFromFile(file, alpha);
-    return _texturesMap[name];
+TextureView ResourceManager::loadTexture(const GLchar *file,
+                                         bool alpha,
+                                         const std::string& name){
+    PROFILE_SCOPE("ResourceManager::loadTexture");
+    Texture2D& texture = _texturesMap[name] = loadTextureFromFile(file, alpha);
+    return texture.view();
 }
 
-Texture2D ResourceManager::getTexture(const std::string& name){
-    return _texturesMap[name];
+TextureView ResourceManager::getTexture(const std::string& name){
+    auto it = _texturesMap.find(name);
+    return it != _texturesMap.end() ? it->second.view() : TextureView();
 }
 
 void ResourceManager::clear(){
-    // (Properly) delete all shaders
-    for (auto iter : _shadersMap)
-        glDeleteProgram(iter.second.ID);
+    // (Properly) delete all shaders, the owning handles release the programs
+    _shadersMap.clear();
+    _programsMap.clear();
     // (Properly) delete all textures
-    for (auto iter : _texturesMap)
-        glDeleteTextures(1, &iter.second.ID);
+    _texturesMap.clear();
+}
+
+bool ResourceManager::mountAssetPack(const std::string& packFile){
+    return _assetPack.mount(packFile);
+}
+
+AssetView ResourceManager::findAsset(const std::string& file){
+    return _assetPack.find(file);
+}
+
+std::string ResourceManager::loadText(const GLchar *file){
+    AssetView asset = findAsset(file);
+    if (asset)
+        return std::string(asset.c_str(), asset.Size);
+    std::ifstream stream(file);
+    if (!stream)
+        std::cout << "ERROR::RESOURCEMANAGER: Failed to read " << file << std::endl;
+    std::stringstream contents;
+    contents << stream.rdbuf();
+    return contents.str();
 }
 
 Shader ResourceManager::loadShaderFromFile(const GLchar *vShaderFile,
                                            const GLchar *fShaderFile,
                                            const GLchar *gShaderFile){
+    // Packed sources are '\0' terminated inside the mapping, so they can be compiled in place
+    AssetView vertexAsset = findAsset(vShaderFile);
+    AssetView fragmentAsset = findAsset(fShaderFile);
+    AssetView geometryAsset = gShaderFile != nullptr ? findAsset(gShaderFile) : AssetView();
+    if (vertexAsset && fragmentAsset && (gShaderFile == nullptr || geometryAsset)){
+        Shader shader;
+        shader.compile(vertexAsset.c_str(), fragmentAsset.c_str(), gShaderFile != nullptr ? geometryAsset.c_str() : nullptr);
+        return shader;
+    }
     // 1. Retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
     std::string fragmentCode;
@@ -111,9 +149,13 @@ Texture2D ResourceManager::loadTextureFromFile(const GLchar *file,
     }
     // Load image
     int width, height;
-    unsigned char* image = SOIL_load_image(file, &width, &height, 0,
-                                           texture.Image_Format == GL_RGBA ?
-                                           SOIL_LOAD_RGBA : SOIL_LOAD_RGB);
+    int channels = texture.Image_Format == GL_RGBA ? SOIL_LOAD_RGBA : SOIL_LOAD_RGB;
+    unsigned char* image;
+    AssetView asset = findAsset(file);
+    if (asset)
+        image = SOIL_load_image_from_memory(asset.Data, static_cast<int>(asset.Size), &width, &height, 0, channels);
+    else
+        image = SOIL_load_image(file, &width, &height, 0, channels);
     // Now generate texture
     texture.generate(width, height, image);
     // And finally free image data
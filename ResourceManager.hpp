@@ -22,6 +22,8 @@
 
 #include <GL/glew.h>
 
+#include "AssetPack.hpp"
+#include "GLResource.hpp"
 #include "Texture.hpp"
 #include "Shader.hpp"
 
@@ -31,6 +33,8 @@
 // and/or shader is also stored for future reference by string
 // handles. All functions and resources are static and no
 // public constructor is defined.
+// The ResourceManager owns every texture and program it loads;
+// callers only ever receive non-owning handles (Shader/TextureView).
 class ResourceManager{
 public:
     // Loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader
@@ -41,13 +45,20 @@ public:
     // Retrieves a stored sader
     static Shader   getShader(const std::string& name);
     // Loads (and generates) a texture from file
-    static Texture2D loadTexture(const GLchar *file,
-                                 bool alpha,
-                                 const std::string& name);
-    // Retrieves a stored texture
-    static Texture2D getTexture(const std::string& name);
+    static TextureView loadTexture(const GLchar *file,
+                                   bool alpha,
+                                   const std::string& name);
+    // Retrieves a stored texture (an empty view if it was never loaded)
+    static TextureView getTexture(const std::string& name);
     // Properly de-allocates all loaded resources
     static void      clear();
+    // Maps a packed asset file; while mounted, assets are read from the pack instead of loose files
+    static bool      mountAssetPack(const std::string& packFile);
+    // Returns the packed bytes of an asset, or an empty view if no pack is mounted or the asset
+    // isn't packed (callers then fall back to the loose file)
+    static AssetView findAsset(const std::string& file);
+    // Reads a whole text asset (packed or loose), e.g. shader sources that need preprocessing
+    static std::string loadText(const GLchar *file);
 private:
     // Private constructor, that is we do not want any actual resource manager objects. Its members and functions should be publicly available (static).
     ResourceManager() { }
@@ -61,7 +72,9 @@ private:
     
     // Resource storage
     static std::map<std::string, Shader>    _shadersMap;
+    static std::map<std::string, GLProgram> _programsMap;
     static std::map<std::string, Texture2D> _texturesMap;
+    static AssetPack                        _assetPack;
 };
 
 #endif
@@ -0,0 +1,13 @@
+#version 330 core
+// Adds the blurred bright parts back on top of the scene
+in  vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D scene;
+uniform sampler2D previous;
+uniform float     bloom_intensity;
+
+void main(){
+    vec3 glow = texture(previous, TexCoords).rgb * bloom_intensity;
+    color = vec4(texture(scene, TexCoords).rgb + glow, 1.0);
+}
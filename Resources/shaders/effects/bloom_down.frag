@@ -0,0 +1,18 @@
+#version 330 core
+// Dual-filter (Kawase) downsample: centre plus four diagonal taps, each one
+// bilinearly filtered, so five fetches cover a 4x4 footprint of the input
+in  vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D previous;
+uniform vec2      resolution;
+
+void main(){
+    vec2 halfpixel = 0.5 / resolution;
+    vec3 sum = texture(previous, TexCoords).rgb * 4.0;
+    sum += texture(previous, TexCoords - halfpixel).rgb;
+    sum += texture(previous, TexCoords + halfpixel).rgb;
+    sum += texture(previous, TexCoords + vec2(halfpixel.x, -halfpixel.y)).rgb;
+    sum += texture(previous, TexCoords - vec2(halfpixel.x, -halfpixel.y)).rgb;
+    color = vec4(sum / 8.0, 1.0);
+}
@@ -0,0 +1,27 @@
+#version 330 core
+// Bloom bright pass: keeps what is brighter than the threshold (with a soft knee)
+// and downsamples it with the dual-filter kernel: centre plus four diagonal taps
+in  vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D previous;
+uniform vec2      resolution;
+uniform float     bloom_threshold;
+
+vec3 bright(vec3 c){
+    float brightness = max(c.r, max(c.g, c.b));
+    float knee = bloom_threshold * 0.5;
+    float soft = clamp(brightness - bloom_threshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 0.00001);
+    return c * (max(soft, brightness - bloom_threshold) / max(brightness, 0.00001));
+}
+
+void main(){
+    vec2 halfpixel = 0.5 / resolution;
+    vec3 sum = bright(texture(previous, TexCoords).rgb) * 4.0;
+    sum += bright(texture(previous, TexCoords - halfpixel).rgb);
+    sum += bright(texture(previous, TexCoords + halfpixel).rgb);
+    sum += bright(texture(previous, TexCoords + vec2(halfpixel.x, -halfpixel.y)).rgb);
+    sum += bright(texture(previous, TexCoords - vec2(halfpixel.x, -halfpixel.y)).rgb);
+    color = vec4(sum / 8.0, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 330 core
+// Dual-filter (Kawase) upsample: a tent of eight bilinear taps around the pixel
+in  vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D previous;
+uniform vec2      resolution;
+
+void main(){
+    vec2 halfpixel = 0.5 / resolution;
+    vec3 sum = texture(previous, TexCoords + vec2(-halfpixel.x * 2.0, 0.0)).rgb;
+    sum += texture(previous, TexCoords + vec2(-halfpixel.x,  halfpixel.y)).rgb * 2.0;
+    sum += texture(previous, TexCoords + vec2(0.0,  halfpixel.y * 2.0)).rgb;
+    sum += texture(previous, TexCoords + vec2( halfpixel.x,  halfpixel.y)).rgb * 2.0;
+    sum += texture(previous, TexCoords + vec2( halfpixel.x * 2.0, 0.0)).rgb;
+    sum += texture(previous, TexCoords + vec2( halfpixel.x, -halfpixel.y)).rgb * 2.0;
+    sum += texture(previous, TexCoords + vec2(0.0, -halfpixel.y * 2.0)).rgb;
+    sum += texture(previous, TexCoords + vec2(-halfpixel.x, -halfpixel.y)).rgb * 2.0;
+    color = vec4(sum / 12.0, 1.0);
+}
@@ -0,0 +1,11 @@
+// Colour grading: contrast and saturation around mid-grey, then a tint
+uniform float grade_contrast;
+uniform float grade_saturation;
+uniform vec3  grade_tint;
+
+vec4 effect(vec4 color, vec2 uv){
+    vec3 graded = (color.rgb - 0.5) * grade_contrast + 0.5;
+    float luma = dot(graded, vec3(0.299, 0.587, 0.114));
+    graded = mix(vec3(luma), graded, grade_saturation) * grade_tint;
+    return vec4(clamp(graded, 0.0, 1.0), color.a);
+}
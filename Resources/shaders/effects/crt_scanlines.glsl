@@ -0,0 +1,9 @@
+// CRT look: darkens every other scanline and the corners of the screen
+uniform float scanlines_strength;
+
+vec4 effect(vec4 color, vec2 uv){
+    float line = mod(floor(gl_FragCoord.y), 2.0) == 0.0 ? 1.0 : 1.0 - scanlines_strength;
+    vec2 center = uv - 0.5;
+    float vignette = 1.0 - dot(center, center) * 0.8;
+    return vec4(color.rgb * line * vignette, color.a);
+}
@@ -1,36 +1,98 @@
 #version 330 core
+// Compiled once per effect combination: PostProcessor injects CHAOS, CONFUSE,
+// SHAKE and FXAA as needed, plus the OFFSETS/EDGE_KERNEL/BLUR_KERNEL/TEXEL_SIZE constants.
+// Drawing this pass is also what upscales a scene rendered below full resolution
 in  vec2  TexCoords;
 out vec4  color;
   
 uniform sampler2D scene;
-uniform vec2      offsets[9];
-uniform int       edge_kernel[9];
-uniform float     blur_kernel[9];
+// Part of the scene texture rendered this frame (dynamic resolution)
+uniform vec2      sceneScale;
+const vec2 texelSize = TEXEL_SIZE;
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
+// Chaos wins over confuse, which wins over shake; only chaos and shake convolve
+#if defined(CHAOS) || (defined(SHAKE) && !defined(CONFUSE))
+#define CONVOLUTION
+const vec2  offsets[9]     = OFFSETS;
+#endif
+#if defined(CHAOS)
+const float edge_kernel[9] = EDGE_KERNEL;
+#elif defined(CONVOLUTION)
+const float blur_kernel[9] = BLUR_KERNEL;
+#endif
+
+// Maps screen coordinates into the rendered part of the scene texture
+vec2 sceneUV(vec2 uv){
+#ifdef CHAOS
+    // chaos relies on the texture wrapping around, which has to stay inside the rendered part
+    return fract(uv) * sceneScale;
+#else
+    return clamp(uv * sceneScale, 0.5 * texelSize, sceneScale - 0.5 * texelSize);
+#endif
+}
+
+#ifdef FXAA
+#define FXAA_REDUCE_MIN (1.0 / 128.0)
+#define FXAA_REDUCE_MUL (1.0 / 8.0)
+#define FXAA_SPAN_MAX   8.0
+
+// Single-pass FXAA: blurs along the local edge direction, only where there is contrast.
+// uv is in scene texture space
+vec3 fxaaSample(vec2 uv){
+    vec3 luma  = vec3(0.299, 0.587, 0.114);
+    vec3 rgbM  = texture(scene, uv).rgb;
+    float lumaNW = dot(texture(scene, uv + vec2(-1.0, -1.0) * texelSize).rgb, luma);
+    float lumaNE = dot(texture(scene, uv + vec2( 1.0, -1.0) * texelSize).rgb, luma);
+    float lumaSW = dot(texture(scene, uv + vec2(-1.0,  1.0) * texelSize).rgb, luma);
+    float lumaSE = dot(texture(scene, uv + vec2( 1.0,  1.0) * texelSize).rgb, luma);
+    float lumaM  = dot(rgbM, luma);
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+    vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)),
+                     ((lumaNW + lumaSW) - (lumaNE + lumaSE)));
+    float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 * FXAA_REDUCE_MUL), FXAA_REDUCE_MIN);
+    float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+    dir = clamp(dir * rcpDirMin, vec2(-FXAA_SPAN_MAX), vec2(FXAA_SPAN_MAX)) * texelSize;
+
+    vec3 rgbA = 0.5 * (texture(scene, uv + dir * (1.0 / 3.0 - 0.5)).rgb +
+                       texture(scene, uv + dir * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 rgbB = rgbA * 0.5 + 0.25 * (texture(scene, uv + dir * -0.5).rgb +
+                                     texture(scene, uv + dir *  0.5).rgb);
+    float lumaB = dot(rgbB, luma);
+    return (lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB;
+}
+
+vec4 sceneSample(vec2 uv){
+    return vec4(fxaaSample(sceneUV(uv)), 1.0);
+}
+#else
+vec4 sceneSample(vec2 uv){
+    return texture(scene, sceneUV(uv));
+}
+#endif
 
 void main(){
     color = vec4(0.0f);
+#ifdef CONVOLUTION
+    // sample from texture offsets for the convolution matrix
     vec3 sample[9];
-    // sample from texture offsets if using convolution matrix
-    if(chaos || shake)
-        for(int i = 0; i < 9; i++)
-            sample[i] = vec3(texture(scene, TexCoords.st + offsets[i]));
+    for(int i = 0; i < 9; i++)
+        sample[i] = vec3(texture(scene, sceneUV(TexCoords.st + offsets[i])));
+#endif
 
     // process effects
-    if(chaos){
-        for(int i = 0; i < 9; i++)
-            color += vec4(sample[i] * edge_kernel[i], 0.0f);
-        color.a = 1.0f;
-    } else if(confuse){
-        color = vec4(1.0 - texture(scene, TexCoords).rgb, 1.0);
-    } else if(shake){
-        for(int i = 0; i < 9; i++)
-            color += vec4(sample[i] * blur_kernel[i], 0.0f);
-        color.a = 1.0f;
-    } else{
-        color =  texture(scene, TexCoords);
-    }
+#if defined(CHAOS)
+    for(int i = 0; i < 9; i++)
+        color += vec4(sample[i] * edge_kernel[i], 0.0f);
+    color.a = 1.0f;
+#elif defined(CONFUSE)
+    color = vec4(1.0 - sceneSample(TexCoords).rgb, 1.0);
+#elif defined(SHAKE)
+    for(int i = 0; i < 9; i++)
+        color += vec4(sample[i] * blur_kernel[i], 0.0f);
+    color.a = 1.0f;
+#else
+    color = sceneSample(TexCoords);
+#endif
 }
@@ -0,0 +1,135 @@
+//
+//  ScalingBenchmark.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "ScalingBenchmark.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "Game.hpp"
+#include "Profiler.hpp"
+#include "Clock.hpp"
+
+namespace {
+    // The PROFILE_SCOPEs of Game::update reported, under a stable name
+    struct Subsystem {
+        const char* Name;
+        const char* Scope;
+    };
+    const Subsystem SUBSYSTEMS[] = {
+        { "tick",       "Game::update" },
+        { "ball",       "Ball::move" },
+        { "collision",  "Game::doCollisions" },
+        { "particles",  "Particles::update" },
+        { "powerups",   "Game::updatePowerUps" },
+        { "completion", "GameModel::isCompleted" },
+        { "snapshot",   "Game::publishSnapshot" },
+    };
+    const std::size_t SUBSYSTEM_COUNT = sizeof(SUBSYSTEMS) / sizeof(SUBSYSTEMS[0]);
+
+    double percentile(const std::vector<double>& sorted, double fraction){
+        std::size_t index = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    double mean(const std::vector<double>& samples){
+        double sum = 0.0;
+        for (double sample : samples)
+            sum += sample;
+        return samples.empty() ? 0.0 : sum / samples.size();
+    }
+}
+
+std::vector<LevelSpec> ScalingBenchmark::defaultLevels(){
+    const int sizes[][2] = { {15, 8}, {30, 16}, {60, 32}, {125, 63}, {250, 125}, {500, 250}, {1000, 500}, {2000, 1000} };
+    std::vector<LevelSpec> levels;
+    for (const auto& size : sizes){
+        LevelSpec spec;
+        spec.Width = size[0];
+        spec.Height = size[1];
+        levels.push_back(spec);
+    }
+    return levels;
+}
+
+ScalingBenchmark::ScalingBenchmark(Game& game, int ticks, float step) : _game(game), _ticks(ticks), _step(step){ }
+
+void ScalingBenchmark::run(const std::vector<LevelSpec>& levels){
+    bool statsWereEnabled = Profiler::isStatsEnabled();
+    Profiler::setStatsEnabled(true);
+    _game.setAutoplay(true);
+    for (const LevelSpec& spec : levels){
+        Result result;
+        result.Level = spec;
+        GameLevel level = ProceduralLevel::generate(spec);
+        if (level._boardData.empty())
+            continue;
+        for (const std::vector<GLuint>& row : level._boardData)
+            result.Bricks += std::count_if(row.begin(), row.end(), [](GLuint tile){ return tile != 0; });
+        uint64_t loadBegin = Clock::now();
+        _game.loadLevel(level);
+        result.LoadMs = Clock::toMilliseconds(Clock::now() - loadBegin);
+        result.Samples.assign(SUBSYSTEM_COUNT, std::vector<double>());
+        // Discard the totals of whatever ran before the first tick
+        Profiler::endFrame();
+        uint64_t pairsBefore = _game.collisionTotals().PairsTested;
+        for (int tick = 0; tick < _ticks; ++tick){
+            _game.update(_step);
+            Profiler::endFrame();
+            std::vector<ScopeTotal> totals = Profiler::lastFrameTotals();
+            for (std::size_t i = 0; i < SUBSYSTEM_COUNT; ++i){
+                uint64_t total = 0;
+                for (const ScopeTotal& scope : totals)
+                    if (std::strcmp(scope.Name, SUBSYSTEMS[i].Scope) == 0)
+                        total += scope.Total;
+                result.Samples[i].push_back(total / 1e3);
+            }
+        }
+        result.PairsPerTick = double(_game.collisionTotals().PairsTested - pairsBefore) / _ticks;
+        std::cout << "Scaling benchmark " << spec.Width << "x" << spec.Height << " (" << result.Bricks << " bricks): tick "
+                  << mean(result.Samples[0]) << " us, collision " << mean(result.Samples[2]) << " us ("
+                  << result.PairsPerTick << " pairs), completion "
+                  << mean(result.Samples[5]) << " us, snapshot " << mean(result.Samples[6]) << " us" << std::endl;
+        _results.push_back(std::move(result));
+    }
+    _game.setAutoplay(false);
+    Profiler::setStatsEnabled(statsWereEnabled);
+}
+
+bool ScalingBenchmark::writeJson(const std::string& file) const{
+    std::ofstream out(file, std::ios::trunc);
+    if (!out){
+        std::cout << "ERROR::SCALINGBENCHMARK: Failed to write " << file << std::endl;
+        return false;
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"benchmark\": \"scaling\",\n  \"ticks\": " << _ticks << ",\n  \"step_ms\": " << _step * 1000.0f
+        << ",\n  \"unit\": \"us\",\n  \"levels\": [";
+    for (std::size_t r = 0; r < _results.size(); ++r){
+        const Result& result = _results[r];
+        out << (r ? "," : "") << "\n    {\"width\": " << result.Level.Width << ", \"height\": " << result.Level.Height
+            << ", \"tiles\": " << static_cast<long long>(result.Level.Width) * result.Level.Height
+            << ", \"bricks\": " << result.Bricks << ", \"density\": " << result.Level.Density
+            << ", \"solid_ratio\": " << result.Level.SolidRatio << ", \"seed\": " << result.Level.Seed
+            << ", \"load_ms\": " << result.LoadMs << ", \"pairs_per_tick\": " << result.PairsPerTick << ",\n     \"subsystems\": {";
+        for (std::size_t i = 0; i < SUBSYSTEM_COUNT; ++i){
+            std::vector<double> sorted = result.Samples[i];
+            std::sort(sorted.begin(), sorted.end());
+            out << (i ? "," : "") << "\n       \"" << SUBSYSTEMS[i].Name << "\": {\"scope\": \"" << SUBSYSTEMS[i].Scope << "\"";
+            if (!sorted.empty())
+                out << ", \"mean\": " << mean(sorted) << ", \"p50\": " << percentile(sorted, 0.5)
+                    << ", \"p99\": " << percentile(sorted, 0.99) << ", \"max\": " << sorted.back();
+            out << "}";
+        }
+        out << "\n     }}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,45 @@
+//
+//  ScalingBenchmark.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ProceduralLevel.hpp"
+
+class Game;
+
+// ScalingBenchmark plays generated levels of growing size on autoplay and
+// records how long each simulation subsystem takes per tick (collision,
+// completion check, power-ups, particles...), from the profiler's scope
+// totals, to show how each one scales with the board. Only the simulation
+// runs: nothing is drawn, so the numbers are CPU time alone. Results are
+// written as JSON.
+class ScalingBenchmark{
+public:
+    // Board sizes from the hand-made 15x8 up to 2000x1000
+    static std::vector<LevelSpec> defaultLevels();
+
+    ScalingBenchmark(Game& game, int ticks, float step);
+    // Runs ticks simulation steps on each level in turn, printing a summary line per level
+    void run(const std::vector<LevelSpec>& levels);
+    bool writeJson(const std::string& file) const;
+private:
+    struct Result {
+        LevelSpec Level;
+        long long Bricks = 0;
+        double LoadMs = 0.0;
+        double PairsPerTick = 0.0; // Ball - brick pairs the narrowphase tested
+        // Per subsystem, its time in every tick (us)
+        std::vector<std::vector<double>> Samples;
+    };
+    Game& _game;
+    int _ticks;
+    float _step;
+    std::vector<Result> _results;
+};
@@ -0,0 +1,180 @@
+//
+//  AssetPack.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "AssetPack.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char PACK_MAGIC[4] = { 'B', 'K', 'P', 'K' };
+    const uint64_t PACK_ALIGNMENT = 16;
+
+    uint64_t alignUp(uint64_t value){
+        return (value + PACK_ALIGNMENT - 1) & ~(PACK_ALIGNMENT - 1);
+    }
+}
+
+AssetPack::~AssetPack(){
+    unmount();
+}
+
+bool AssetPack::mount(const std::string& path){
+    unmount();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(AssetPackHeader))){
+        close(fd);
+        return false;
+    }
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (mapping == MAP_FAILED)
+        return false;
+
+    // Validate the header and index before handing out any pointers
+    const AssetPackHeader* header = static_cast<const AssetPackHeader*>(mapping);
+    uint64_t indexEnd = sizeof(AssetPackHeader) + uint64_t(header->EntryCount) * sizeof(AssetPackEntry);
+    bool valid = std::memcmp(header->Magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0 &&
+                 header->Version == VERSION &&
+                 indexEnd <= size;
+    const AssetPackEntry* entries = reinterpret_cast<const AssetPackEntry*>(static_cast<const unsigned char*>(mapping) + sizeof(AssetPackHeader));
+    for (uint32_t i = 0; valid && i < header->EntryCount; ++i)
+        valid = entries[i].Offset >= indexEnd && entries[i].Offset + entries[i].Size < size; // '<' leaves room for the terminator
+    if (!valid){
+        std::cout << "ERROR::ASSETPACK: Invalid asset pack: " << path << std::endl;
+        munmap(mapping, size);
+        return false;
+    }
+    _mapping = static_cast<const unsigned char*>(mapping);
+    _mappingSize = size;
+    _entries = entries;
+    _entryCount = header->EntryCount;
+    return true;
+}
+
+void AssetPack::unmount(){
+    if (_mapping)
+        munmap(const_cast<unsigned char*>(_mapping), _mappingSize);
+    _mapping = nullptr;
+    _mappingSize = 0;
+    _entries = nullptr;
+    _entryCount = 0;
+}
+
+AssetView AssetPack::find(const std::string& name) const{
+    AssetView view;
+    if (!_mapping)
+        return view;
+    uint64_t hash = hashName(name);
+    const AssetPackEntry* end = _entries + _entryCount;
+    const AssetPackEntry* entry = std::lower_bound(_entries, end, hash,
+                                                   [](const AssetPackEntry& e, uint64_t h){ return e.NameHash < h; });
+    if (entry != end && entry->NameHash == hash){
+        view.Data = _mapping + entry->Offset;
+        view.Size = static_cast<std::size_t>(entry->Size);
+        view.Type = static_cast<AssetType>(entry->Type);
+    }
+    return view;
+}
+
+uint64_t AssetPack::hashName(const std::string& name){
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name){
+        hash ^= static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c)));
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+AssetType AssetPack::typeFromName(const std::string& name){
+    std::string extension = name.substr(name.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == "vs" || extension == "frag" || extension == "gs")
+        return AssetType::Shader;
+    if (extension == "png" || extension == "jpg" || extension == "jpeg")
+        return AssetType::Image;
+    if (extension == "lvl")
+        return AssetType::Level;
+    if (extension == "ttf")
+        return AssetType::Font;
+    return AssetType::Raw;
+}
+
+bool AssetPack::write(const std::string& packFile, const std::vector<std::string>& files){
+    // Read every file and build the (sorted) index
+    std::vector<std::vector<char>> contents;
+    std::vector<AssetPackEntry> entries;
+    for (const std::string& file : files){
+        std::ifstream stream(file, std::ios::binary);
+        if (!stream){
+            std::cout << "ERROR::ASSETPACK: Failed to read " << file << std::endl;
+            return false;
+        }
+        contents.emplace_back(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        AssetPackEntry entry = {};
+        entry.NameHash = hashName(file);
+        entry.Size = contents.back().size();
+        entry.Type = static_cast<uint32_t>(typeFromName(file));
+        entry.Reserved = static_cast<uint32_t>(contents.size() - 1); // Temporarily holds the content index
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const AssetPackEntry& a, const AssetPackEntry& b){ return a.NameHash < b.NameHash; });
+    for (std::size_t i = 1; i < entries.size(); ++i){
+        if (entries[i].NameHash == entries[i - 1].NameHash){
+            std::cout << "ERROR::ASSETPACK: Duplicate (or colliding) asset name " << files[entries[i].Reserved] << std::endl;
+            return false;
+        }
+    }
+    // Lay out the data after the index
+    uint64_t offset = alignUp(sizeof(AssetPackHeader) + entries.size() * sizeof(AssetPackEntry));
+    for (AssetPackEntry& entry : entries){
+        entry.Offset = offset;
+        offset = alignUp(offset + entry.Size + 1);
+    }
+
+    std::ofstream out(packFile, std::ios::binary | std::ios::trunc);
+    if (!out){
+        std::cout << "ERROR::ASSETPACK: Failed to create " << packFile << std::endl;
+        return false;
+    }
+    AssetPackHeader header = {};
+    std::memcpy(header.Magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.Version = VERSION;
+    header.EntryCount = static_cast<uint32_t>(entries.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const AssetPackEntry& entry : entries){
+        AssetPackEntry stored = entry;
+        stored.Reserved = 0;
+        out.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+    }
+    for (const AssetPackEntry& entry : entries){
+        const std::vector<char>& data = contents[entry.Reserved];
+        // Pad up to the entry's offset, write the data and its terminator
+        while (static_cast<uint64_t>(out.tellp()) < entry.Offset)
+            out.put('\0');
+        out.write(data.data(), data.size());
+        out.put('\0');
+    }
+    while (static_cast<uint64_t>(out.tellp()) < offset)
+        out.put('\0');
+    return static_cast<bool>(out);
+}
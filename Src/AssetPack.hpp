@@ -0,0 +1,83 @@
+//
+//  AssetPack.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Kind of data stored in a pack entry (informational, loaders know what they asked for)
+enum class AssetType : uint32_t {
+    Raw, Shader, Image, Level, Font
+};
+
+// A read-only, non-owning view of an asset's bytes. When it comes from a
+// pack, Data points straight into the memory mapping and is followed by a
+// '\0' terminator (not counted in Size), so text assets can be used as C strings.
+struct AssetView {
+    const unsigned char* Data = nullptr;
+    std::size_t Size = 0;
+    AssetType Type = AssetType::Raw;
+
+    explicit operator bool() const { return Data != nullptr; }
+    const char* c_str() const { return reinterpret_cast<const char*>(Data); }
+};
+
+// On-disk layout:
+//   AssetPackHeader
+//   AssetPackEntry[entryCount]   (sorted by nameHash)
+//   entry data, each 16-byte aligned and '\0' terminated
+struct AssetPackHeader {
+    char     Magic[4];   // "BKPK"
+    uint32_t Version;
+    uint32_t EntryCount;
+    uint32_t Reserved;
+};
+
+struct AssetPackEntry {
+    uint64_t NameHash;
+    uint64_t Offset;     // from the start of the pack
+    uint64_t Size;       // without the '\0' terminator
+    uint32_t Type;
+    uint32_t Reserved;
+};
+
+// AssetPack memory-maps a single pack file holding every game asset and
+// hands out pointers into the mapping, so loading an asset costs no
+// open/stat/read syscalls and no intermediate copies.
+class AssetPack{
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    AssetPack() = default;
+    ~AssetPack();
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Maps the pack at the given path. Returns false (and stays unmounted) if it is missing or invalid
+    bool mount(const std::string& path);
+    // Releases the mapping; views handed out before become invalid
+    void unmount();
+    bool isMounted() const { return _mapping != nullptr; }
+    // Looks up an asset by the path it was packed with (an empty view if it isn't in the pack)
+    AssetView find(const std::string& name) const;
+
+    // Hash used for the index. Case-insensitive, like the default macOS file system the
+    // game is developed on, so "ocraext.TTF" and "OCRAEXT.TTF" resolve to the same entry.
+    static uint64_t hashName(const std::string& name);
+    // Guesses the asset type from the file extension
+    static AssetType typeFromName(const std::string& name);
+    // Builds a pack from the given loose files (used by the AssetPacker tool)
+    static bool write(const std::string& packFile, const std::vector<std::string>& files);
+private:
+    const unsigned char* _mapping = nullptr;
+    std::size_t _mappingSize = 0;
+    const AssetPackEntry* _entries = nullptr;
+    uint32_t _entryCount = 0;
+};
@@ -0,0 +1,67 @@
+//
+//  Bloom.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "Bloom.hpp"
+
+#include <string>
+
+namespace {
+    // Downsample steps at High quality; lower presets disable the deepest ones
+    const int MAX_LEVELS = 4;
+}
+
+Bloom::Bloom(EffectChain& chain) : _chain(chain){
+    // Down: 1/2 (with the bright pass), 1/4, 1/8, 1/16
+    for (int level = 1; level <= MAX_LEVELS; ++level){
+        EffectPass down;
+        down.Name = "bloom_down" + std::to_string(level);
+        down.ShaderFile = level == 1 ? "Resources/shaders/effects/bloom_prefilter.frag"
+                                     : "Resources/shaders/effects/bloom_down.frag";
+        down.Scale = 1.0f / (1 << level);
+        if (level == 1)
+            down.SetUniforms = [this](Shader& shader){ shader.setFloat("bloom_threshold", Threshold); };
+        _chain.add(std::move(down));
+    }
+    // Up: back to 1/8, 1/4, 1/2
+    for (int level = MAX_LEVELS - 1; level >= 1; --level){
+        EffectPass up;
+        up.Name = "bloom_up" + std::to_string(level);
+        up.ShaderFile = "Resources/shaders/effects/bloom_up.frag";
+        up.Scale = 1.0f / (1 << level);
+        _chain.add(std::move(up));
+    }
+    EffectPass composite;
+    composite.Name = "bloom_composite";
+    composite.ShaderFile = "Resources/shaders/effects/bloom_composite.frag";
+    composite.Inputs = { "scene", "previous" };
+    composite.SetUniforms = [this](Shader& shader){ shader.setFloat("bloom_intensity", Intensity); };
+    _chain.add(std::move(composite));
+    setQuality(BloomQuality::Off);
+}
+
+void Bloom::setQuality(BloomQuality quality){
+    _quality = quality;
+    int levels = quality == BloomQuality::High   ? MAX_LEVELS
+               : quality == BloomQuality::Medium ? MAX_LEVELS - 1
+               : quality == BloomQuality::Low    ? MAX_LEVELS - 2 : 0;
+    // The up passes read "previous", so dropping the deepest down and up steps keeps the chain whole
+    for (int level = 1; level <= MAX_LEVELS; ++level){
+        _chain.find("bloom_down" + std::to_string(level))->Enabled = level <= levels;
+        if (level < MAX_LEVELS)
+            _chain.find("bloom_up" + std::to_string(level))->Enabled = level < levels;
+    }
+    _chain.find("bloom_composite")->Enabled = levels > 0;
+}
+
+const char* Bloom::qualityName(BloomQuality quality){
+    switch (quality){
+        case BloomQuality::Low:    return "low";
+        case BloomQuality::Medium: return "medium";
+        case BloomQuality::High:   return "high";
+        default:                   return "off";
+    }
+}
@@ -0,0 +1,140 @@
+//
+//  BrickLayer.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "BrickLayer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "Screen.hpp"
+
+namespace {
+    // Side of a broadphase cell, in pixels
+    const int CELL = 32;
+}
+
+BrickLayer::BrickLayer(GLuint width, GLuint height) : _width(width), _height(height){
+    _fbo.generate();
+    _texture.setWrap(GL_CLAMP_TO_EDGE);
+    _texture.generate(width, height, NULL);
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo.get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture.getID(), 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::BRICKLAYER: Failed to initialize " << width << "x" << height << " framebuffer" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, Screen::framebuffer());
+}
+
+void BrickLayer::update(SpriteRenderer& renderer, TextureView background, const std::vector<SpriteInstance>& board,
+                        uint32_t version, const std::vector<uint32_t>& destroyed){
+    bool reload = !_valid || version != _version || destroyed.size() < _applied;
+    if (!reload && destroyed.size() == _applied)
+        return;
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo.get());
+    glViewport(0, 0, _width, _height);
+    if (reload){
+        _valid = true;
+        _version = version;
+        _destroyed.assign(board.size(), false);
+        for (uint32_t index : destroyed)
+            _destroyed[index] = true;
+        _applied = destroyed.size();
+        buildGrid(board);
+        redrawAll(renderer, background, board);
+    }
+    else{
+        // Take all of them out first, so no rectangle draws a brick another one removes
+        for (std::size_t i = _applied; i < destroyed.size(); ++i)
+            _destroyed[destroyed[i]] = true;
+        glEnable(GL_SCISSOR_TEST);
+        for (; _applied < destroyed.size(); ++_applied)
+            redraw(renderer, background, board, pixelsOf(board[destroyed[_applied]]));
+        glDisable(GL_SCISSOR_TEST);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, Screen::framebuffer());
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void BrickLayer::draw(SpriteRenderer& renderer){
+    // The texture's rows go bottom up, so it is drawn upside down, which turns the quad's back to
+    // the camera: culling is off for it. Blending is off too: the layer is opaque, but its alpha
+    // went through the bricks' blending and is not 1 where they are translucent
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    renderer.drawSprite(_texture.view(), glm::vec2(0.0f, static_cast<float>(_height)),
+                        glm::vec2(static_cast<float>(_width), -static_cast<float>(_height)));
+    glEnable(GL_BLEND);
+    glEnable(GL_CULL_FACE);
+}
+
+void BrickLayer::redrawAll(SpriteRenderer& renderer, TextureView background, const std::vector<SpriteInstance>& board){
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    renderer.drawSprite(background, glm::vec2(0.0f), glm::vec2(_width, _height));
+    for (std::size_t i = 0; i < board.size(); ++i)
+        if (!_destroyed[i])
+            renderer.drawSprite(board[i]);
+}
+
+void BrickLayer::redraw(SpriteRenderer& renderer, TextureView background, const std::vector<SpriteInstance>& board, const Rect& rect){
+    if (rect.X0 >= rect.X1 || rect.Y0 >= rect.Y1)
+        return;
+    // Scissor boxes count rows from the bottom
+    glScissor(rect.X0, _height - rect.Y1, rect.X1 - rect.X0, rect.Y1 - rect.Y0);
+    renderer.drawSprite(background, glm::vec2(0.0f), glm::vec2(_width, _height));
+    int column0 = rect.X0 / CELL, column1 = (rect.X1 - 1) / CELL;
+    int row0 = rect.Y0 / CELL, row1 = (rect.Y1 - 1) / CELL;
+    for (int row = row0; row <= row1; ++row)
+        for (int column = column0; column <= column1; ++column){
+            int cell = row * _columns + column;
+            for (uint32_t i = _cellStart[cell]; i < _cellStart[cell + 1]; ++i){
+                uint32_t index = _cellBricks[i];
+                if (_destroyed[index])
+                    continue;
+                Rect brick = pixelsOf(board[index]);
+                if (brick.X1 <= rect.X0 || brick.X0 >= rect.X1 || brick.Y1 <= rect.Y0 || brick.Y0 >= rect.Y1)
+                    continue;
+                // A brick in several cells is drawn from the first one both it and the rectangle cover
+                if (column != std::max(column0, brick.X0 / CELL) || row != std::max(row0, brick.Y0 / CELL))
+                    continue;
+                renderer.drawSprite(board[index]);
+            }
+        }
+}
+
+BrickLayer::Rect BrickLayer::pixelsOf(const SpriteInstance& brick) const{
+    Rect rect;
+    rect.X0 = std::max(0, static_cast<int>(std::floor(brick.Position.x)));
+    rect.Y0 = std::max(0, static_cast<int>(std::floor(brick.Position.y)));
+    rect.X1 = std::min(static_cast<int>(_width), static_cast<int>(std::ceil(brick.Position.x + brick.Size.x)));
+    rect.Y1 = std::min(static_cast<int>(_height), static_cast<int>(std::ceil(brick.Position.y + brick.Size.y)));
+    return rect;
+}
+
+void BrickLayer::buildGrid(const std::vector<SpriteInstance>& board){
+    _columns = (static_cast<int>(_width) + CELL - 1) / CELL;
+    _rows = (static_cast<int>(_height) + CELL - 1) / CELL;
+    auto forEachCell = [this](const Rect& rect, auto visit){
+        if (rect.X0 >= rect.X1 || rect.Y0 >= rect.Y1)
+            return;
+        for (int row = rect.Y0 / CELL; row <= (rect.Y1 - 1) / CELL; ++row)
+            for (int column = rect.X0 / CELL; column <= (rect.X1 - 1) / CELL; ++column)
+                visit(row * _columns + column);
+    };
+    // Count the bricks of every cell, turn the counts into offsets, then place the bricks
+    _cellStart.assign(_columns * _rows + 1, 0);
+    for (const SpriteInstance& brick : board)
+        forEachCell(pixelsOf(brick), [this](int cell){ ++_cellStart[cell + 1]; });
+    for (std::size_t cell = 1; cell < _cellStart.size(); ++cell)
+        _cellStart[cell] += _cellStart[cell - 1];
+    _cellBricks.resize(_cellStart.back());
+    std::vector<uint32_t> next(_cellStart.begin(), _cellStart.end() - 1);
+    for (std::size_t index = 0; index < board.size(); ++index)
+        forEachCell(pixelsOf(board[index]), [&](int cell){ _cellBricks[next[cell]++] = static_cast<uint32_t>(index); });
+}
@@ -0,0 +1,58 @@
+//
+//  BrickLayer.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "GLResource.hpp"
+#include "SpriteRenderer.hpp"
+#include "Texture.hpp"
+
+// BrickLayer caches the static part of the scene, the background and the
+// bricks, in an offscreen texture the size of the screen. The whole layer
+// is only drawn when a level is loaded; a destroyed brick only redraws its
+// own rectangle (scissored: the background and the bricks overlapping it).
+// Every frame then draws the layer as a single quad, whatever the number
+// of bricks.
+class BrickLayer{
+public:
+    BrickLayer(GLuint width, GLuint height);
+    // Brings the layer up to date: board holds the bricks as the level was loaded (a new version
+    // means a new level), destroyed the indices of the bricks destroyed since, oldest first.
+    // Call outside of the scene's rendering, as it binds its own framebuffer
+    void update(SpriteRenderer& renderer, TextureView background, const std::vector<SpriteInstance>& board,
+                uint32_t version, const std::vector<uint32_t>& destroyed);
+    // Draws the layer over the whole screen
+    void draw(SpriteRenderer& renderer);
+private:
+    // A rectangle of layer pixels (x, y from the top left, like the scene's coordinates)
+    struct Rect {
+        int X0, Y0, X1, Y1;
+    };
+    void redrawAll(SpriteRenderer& renderer, TextureView background, const std::vector<SpriteInstance>& board);
+    void redraw(SpriteRenderer& renderer, TextureView background, const std::vector<SpriteInstance>& board, const Rect& rect);
+    Rect pixelsOf(const SpriteInstance& brick) const;
+    // Broadphase for redraw(): the bricks overlapping each CELL x CELL pixels cell
+    void buildGrid(const std::vector<SpriteInstance>& board);
+
+    GLuint _width, _height;
+    GLFramebuffer _fbo;
+    Texture2D _texture;
+    // What the layer shows
+    bool _valid = false;
+    uint32_t _version = 0;
+    std::size_t _applied = 0; // Destroyed bricks already removed from the layer
+    std::vector<bool> _destroyed;
+    // Cells in rows; the bricks of cell i are _cellBricks[_cellStart[i], _cellStart[i + 1])
+    int _columns = 0, _rows = 0;
+    std::vector<uint32_t> _cellStart;
+    std::vector<uint32_t> _cellBricks;
+};
@@ -0,0 +1,20 @@
+//
+//  Clock.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "Clock.hpp"
+
+#include <chrono>
+#include <thread>
+
+uint64_t Clock::now(){
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Clock::sleepUntil(uint64_t time){
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(time)));
+}
@@ -0,0 +1,38 @@
+//
+//  Clock.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+
+// Clock is the game's single time source: a monotonic clock read as
+// integer nanoseconds, shared by the game loop, the simulation thread, the
+// frame pacer, input timestamps and the profiler. Integers keep full
+// precision however long the game runs; floats do not (a float holding the
+// seconds since start steps by 2ms after a day and by a whole 60Hz frame
+// after a day and a half). So absolute times stay integers, and only
+// differences (dt) are converted to seconds, or, for animations, the
+// position within their period (phase()).
+class Clock{
+public:
+    // Nanoseconds since an arbitrary fixed point (steady_clock's epoch)
+    static uint64_t now();
+    // Blocks the calling thread until now() reaches time
+    static void sleepUntil(uint64_t time);
+
+    static double toSeconds(uint64_t ns) { return ns / 1e9; }
+    static double toMilliseconds(uint64_t ns) { return ns / 1e6; }
+    static uint64_t fromSeconds(double seconds) { return seconds > 0.0 ? static_cast<uint64_t>(seconds * 1e9 + 0.5) : 0; }
+    // Seconds into the current repetition of a periodic animation. The
+    // wrap happens on integers, so the result is as precise after weeks as
+    // after the first period
+    static float phase(uint64_t ns, uint64_t periodNs) { return static_cast<float>((ns % periodNs) / 1e9); }
+    // Period of the post-processing animations (sin/cos of time, 10 * time and 15 * time all repeat every 2*pi seconds)
+    static constexpr uint64_t EFFECT_PERIOD_NS = 6283185307;
+private:
+    Clock() { }
+};
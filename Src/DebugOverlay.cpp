@@ -0,0 +1,120 @@
+//
+//  DebugOverlay.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "DebugOverlay.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+
+namespace {
+    // Number of frames in the rolling window (one sparkline bar each)
+    const std::size_t WINDOW_FRAMES = 120;
+    const float PANEL_WIDTH = 260.0f;
+    const float GRAPH_HEIGHT = 40.0f;
+    const float LINE_HEIGHT = 14.0f;
+    const float TEXT_SCALE = 0.5f;
+    // Sparkline scale: a bar reaching the top of the graph means this frame time
+    const float GRAPH_MAX_MS = 50.0f;
+
+    float percentile(std::vector<float> samples, float p){
+        std::size_t index = static_cast<std::size_t>(p * (samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    }
+}
+
+DebugOverlay::DebugOverlay(GLuint width, GLuint height)
+    : _frameTimes(WINDOW_FRAMES, 0.0f), _width(width), _height(height){
+    unsigned char white[3] = { 255, 255, 255 };
+    _white.generate(1, 1, white);
+}
+
+void DebugOverlay::toggle(){
+    _visible = !_visible;
+    Profiler::setStatsEnabled(_visible);
+}
+
+void DebugOverlay::addFrameTime(float seconds){
+    _frameTimes[_nextFrame] = seconds * 1000.0f;
+    _nextFrame = (_nextFrame + 1) % WINDOW_FRAMES;
+    _frameCount = std::min(_frameCount + 1, WINDOW_FRAMES);
+}
+
+void DebugOverlay::draw(SpriteRenderer& renderer, TextRenderer& text, const OverlayCounters& counters){
+    if (!_visible || _frameCount == 0)
+        return;
+    PROFILE_SCOPE("DebugOverlay::draw");
+    std::vector<float> samples;
+    samples.reserve(_frameCount);
+    for (std::size_t i = 0; i < _frameCount; ++i)
+        samples.push_back(_frameTimes[(_nextFrame + WINDOW_FRAMES - _frameCount + i) % WINDOW_FRAMES]);
+    float mean = 0.0f;
+    for (float sample : samples)
+        mean += sample;
+    mean /= samples.size();
+    std::vector<ScopeTotal> scopes = Profiler::lastFrameTotals();
+    static const std::vector<ScopeTotal> noScopes;
+    const std::vector<ScopeTotal>& simulationScopes = counters.SimulationScopes ? *counters.SimulationScopes : noScopes;
+
+    // Background panel
+    float x = static_cast<float>(_width) - PANEL_WIDTH - 5.0f;
+    float y = 30.0f;
+    float lines = 7.0f + scopes.size() + (simulationScopes.empty() ? 0.0f : 1.5f + simulationScopes.size());
+    renderer.drawSprite(_white.view(), glm::vec2(x, y), glm::vec2(PANEL_WIDTH, GRAPH_HEIGHT + lines * LINE_HEIGHT + 15.0f), 0.0f, glm::vec3(0.0f));
+
+    // Frame-time sparkline, oldest frame on the left
+    float barWidth = PANEL_WIDTH / WINDOW_FRAMES;
+    for (std::size_t i = 0; i < samples.size(); ++i){
+        float ms = samples[i];
+        float barHeight = std::min(ms / GRAPH_MAX_MS, 1.0f) * GRAPH_HEIGHT;
+        glm::vec3 color = ms <= 1000.0f / 60.0f ? glm::vec3(0.2f, 0.9f, 0.2f)
+                        : ms <= 1000.0f / 30.0f ? glm::vec3(0.9f, 0.9f, 0.2f)
+                        : glm::vec3(0.9f, 0.2f, 0.2f);
+        float barX = x + (WINDOW_FRAMES - samples.size() + i) * barWidth;
+        renderer.drawSprite(_white.view(), glm::vec2(barX, y + 5.0f + GRAPH_HEIGHT - barHeight), glm::vec2(barWidth, barHeight), 0.0f, color);
+    }
+
+    // Text
+    char line[128];
+    float textX = x + 5.0f;
+    float textY = y + GRAPH_HEIGHT + 10.0f;
+    std::snprintf(line, sizeof(line), "FPS %.1f  p50 %.2fms  p99 %.2fms", mean > 0.0f ? 1000.0f / mean : 0.0f,
+                  percentile(samples, 0.5f), percentile(samples, 0.99f));
+    text.renderText(line, textX, textY, TEXT_SCALE);
+    textY += LINE_HEIGHT;
+    std::snprintf(line, sizeof(line), "Draw calls %d  Texture binds %d", RenderStats::drawCalls(), RenderStats::textureBinds());
+    text.renderText(line, textX, textY, TEXT_SCALE);
+    textY += LINE_HEIGHT;
+    std::snprintf(line, sizeof(line), "Particles %d  PowerUps %d", counters.LiveParticles, counters.LivePowerUps);
+    text.renderText(line, textX, textY, TEXT_SCALE);
+    textY += LINE_HEIGHT;
+    std::snprintf(line, sizeof(line), "Collision pairs %d  Contacts %d", counters.CollisionPairs, counters.CollisionContacts);
+    text.renderText(line, textX, textY, TEXT_SCALE);
+    textY += LINE_HEIGHT;
+    std::snprintf(line, sizeof(line), "Bricks remaining %d  Scene scale %d%%", counters.BricksRemaining,
+                  static_cast<int>(counters.SceneScale * 100.0f + 0.5f));
+    text.renderText(line, textX, textY, TEXT_SCALE);
+    textY += LINE_HEIGHT * 1.5f;
+    for (const ScopeTotal& scope : scopes){
+        std::snprintf(line, sizeof(line), "%-26s %6.3fms", scope.Name, scope.Total / 1.0e6);
+        text.renderText(line, textX, textY, TEXT_SCALE, glm::vec3(0.8f, 0.8f, 1.0f));
+        textY += LINE_HEIGHT;
+    }
+    if (simulationScopes.empty())
+        return;
+    textY += LINE_HEIGHT * 0.5f;
+    text.renderText("Simulation thread (last tick)", textX, textY, TEXT_SCALE);
+    textY += LINE_HEIGHT;
+    for (const ScopeTotal& scope : simulationScopes){
+        std::snprintf(line, sizeof(line), "%-26s %6.3fms", scope.Name, scope.Total / 1.0e6);
+        text.renderText(line, textX, textY, TEXT_SCALE, glm::vec3(0.8f, 1.0f, 0.8f));
+        textY += LINE_HEIGHT;
+    }
+}
@@ -0,0 +1,57 @@
+//
+//  DebugOverlay.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Profiler.hpp"
+#include "SpriteRenderer.hpp"
+#include "TextRenderer.hpp"
+#include "Texture.hpp"
+
+// Game-side numbers shown by the overlay
+struct OverlayCounters {
+    int LiveParticles = 0;
+    int LivePowerUps = 0;
+    int BricksRemaining = 0;
+    int CollisionPairs = 0;    // Ball - brick pairs tested in the last tick
+    int CollisionContacts = 0;
+    float SceneScale = 1.0f; // Dynamic resolution scale of the scene
+    // Scope totals of the simulation thread, when it runs apart from the renderer
+    const std::vector<ScopeTotal>* SimulationScopes = nullptr;
+};
+
+// DebugOverlay is a toggleable performance HUD: FPS, frame-time p50/p99
+// over a rolling window, a frame-time sparkline, per-subsystem CPU time
+// (from the Profiler's per-frame totals, plus the simulation thread's
+// per-tick totals in threaded mode), draw calls, texture binds and
+// a few game counters. Numbers are always those of the previous frame,
+// so the overlay's own draws and CPU time are part of what it reports.
+class DebugOverlay{
+public:
+    DebugOverlay(GLuint width, GLuint height);
+    // Shows/hides the overlay (and turns the profiler's per-frame totals on/off with it)
+    void toggle();
+    bool isVisible() const { return _visible; }
+    // Adds a frame to the rolling window
+    void addFrameTime(float seconds);
+    // Draws the overlay on top of everything else
+    void draw(SpriteRenderer& renderer, TextRenderer& text, const OverlayCounters& counters);
+private:
+    // Frame times in ms, used as a ring buffer
+    std::vector<float> _frameTimes;
+    std::size_t _nextFrame = 0;
+    std::size_t _frameCount = 0;
+    bool _visible = false;
+    GLuint _width, _height;
+    // 1x1 white texture used to draw the panel and the sparkline bars
+    Texture2D _white;
+};
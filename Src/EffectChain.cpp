@@ -0,0 +1,223 @@
+//
+//  EffectChain.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "EffectChain.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#include "ResourceManager.hpp"
+#include "RenderStats.hpp"
+#include "Screen.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    GLuint scaled(GLuint size, float scale){
+        return std::max(1u, static_cast<GLuint>(size * scale + 0.5f));
+    }
+}
+
+EffectChain::EffectChain(GLuint width, GLuint height)
+    : _width(width), _height(height){
+    _vao.generate();
+    _vertexSource = ResourceManager::loadText("Resources/shaders/effect_pass.vs");
+}
+
+void EffectChain::add(EffectPass pass){
+    if ((pass.PixelFile == nullptr) == (pass.ShaderFile == nullptr))
+        std::cout << "ERROR::EFFECTCHAIN: Pass " << pass.Name << " needs either a pixel or a shader file" << std::endl;
+    _sources.push_back(ResourceManager::loadText(pass.PixelFile ? pass.PixelFile : pass.ShaderFile));
+    _passes.push_back(std::move(pass));
+    _planned.clear();
+}
+
+EffectPass* EffectChain::find(const std::string& name){
+    for (auto& pass : _passes)
+        if (pass.Name == name)
+            return &pass;
+    return nullptr;
+}
+
+bool EffectChain::empty() const{
+    for (auto& pass : _passes)
+        if (pass.Enabled)
+            return false;
+    return true;
+}
+
+void EffectChain::plan(){
+    _planned.clear();
+    for (auto& pass : _passes)
+        _planned.push_back(pass.Enabled);
+    _steps.clear();
+    for (int i = 0; i < static_cast<int>(_passes.size()); ++i){
+        const EffectPass& pass = _passes[i];
+        if (!pass.Enabled)
+            continue;
+        // A pixel pass reading the previous result at the same scale joins the previous step,
+        // as long as that step is made of pixel passes and nobody else reads its result
+        if (!_steps.empty() && pass.PixelFile && pass.Inputs.front() == "previous"){
+            Step& last = _steps.back();
+            const EffectPass& tail = _passes[last.Passes.back()];
+            if (tail.PixelFile && tail.Output.empty() && last.Scale == pass.Scale){
+                last.Passes.push_back(i);
+                last.Output = pass.Output;
+                continue;
+            }
+        }
+        Step step;
+        step.Passes = { i };
+        step.Inputs = pass.PixelFile ? std::vector<std::string>{ pass.Inputs.front() } : pass.Inputs;
+        step.Output = pass.Output;
+        step.Scale = pass.Scale;
+        step.Readers = 0;
+        _steps.push_back(std::move(step));
+    }
+    // Count the readers of every result, so targets go back to the pool right after their last use
+    for (std::size_t s = 0; s < _steps.size(); ++s){
+        for (auto& input : _steps[s].Inputs){
+            if (input == "previous" && s > 0)
+                ++_steps[s - 1].Readers;
+            else
+                for (std::size_t r = 0; r < s; ++r)
+                    if (!_steps[r].Output.empty() && _steps[r].Output == input)
+                        ++_steps[r].Readers;
+        }
+    }
+    for (auto& step : _steps)
+        step.Program = programFor(step);
+}
+
+Shader EffectChain::programFor(const Step& step){
+    // Fused pixel passes are keyed by their names, shader passes by file and inputs,
+    // so passes sharing a shader (e.g. successive downsamples) share its program too
+    std::string signature;
+    const EffectPass& head = _passes[step.Passes.front()];
+    if (head.ShaderFile){
+        signature = head.ShaderFile;
+        for (auto& input : step.Inputs)
+            signature += ":" + input;
+    }
+    else{
+        for (int index : step.Passes)
+            signature += (signature.empty() ? "" : "+") + _passes[index].Name;
+    }
+    Shader shader;
+    auto it = _programs.find(signature);
+    if (it != _programs.end()){
+        shader.ID = it->second.get();
+        return shader;
+    }
+    PROFILE_SCOPE("EffectChain::compile");
+    std::string fragmentCode;
+    if (head.ShaderFile){
+        fragmentCode = _sources[step.Passes.front()];
+    }
+    else{
+        // Fuse the pixel functions: each one is renamed effect_<n> and called in order
+        fragmentCode = "#version 330 core\n"
+                       "in vec2 TexCoords;\n"
+                       "out vec4 color;\n"
+                       "uniform sampler2D " + step.Inputs.front() + ";\n"
+                       "uniform vec2 resolution;\n";
+        std::string calls;
+        for (std::size_t n = 0; n < step.Passes.size(); ++n){
+            std::string function = "effect_" + std::to_string(n);
+            fragmentCode += "#define effect " + function + "\n#line 1\n"
+                          + _sources[step.Passes[n]] + "\n#undef effect\n";
+            calls += "    result = " + function + "(result, TexCoords);\n";
+        }
+        fragmentCode += "void main(){\n"
+                        "    vec4 result = texture(" + step.Inputs.front() + ", TexCoords);\n"
+                      + calls
+                      + "    color = result;\n"
+                        "}\n";
+    }
+    shader.compile(_vertexSource.c_str(), fragmentCode.c_str());
+    _programs[signature] = GLProgram(shader.ID);
+    // Samplers are bound to units in the order the inputs are declared
+    shader.use();
+    for (std::size_t unit = 0; unit < step.Inputs.size(); ++unit)
+        shader.setInteger(step.Inputs[unit].c_str(), static_cast<GLint>(unit));
+    return shader;
+}
+
+void EffectChain::run(TextureView scene, GLuint targetFramebuffer){
+    PROFILE_SCOPE("EffectChain::run");
+    std::vector<bool> enabled;
+    for (auto& pass : _passes)
+        enabled.push_back(pass.Enabled);
+    if (enabled != _planned)
+        plan();
+    if (_steps.empty())
+        return;
+    
+    // The final step draws with the caller's viewport, which is restored afterwards
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    // Pool target holding each step's result (-1 once released), and its remaining readers
+    std::vector<int> results(_steps.size(), -1);
+    std::vector<int> readers(_steps.size(), 0);
+    glBindVertexArray(_vao.get());
+    for (std::size_t s = 0; s < _steps.size(); ++s){
+        Step& step = _steps[s];
+        bool last = s + 1 == _steps.size();
+        GLuint width = last ? viewport[2] : scaled(_width, step.Scale);
+        GLuint height = last ? viewport[3] : scaled(_height, step.Scale);
+        if (last){
+            glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+            glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        }
+        else{
+            results[s] = _pool.acquire(width, height);
+            readers[s] = step.Readers;
+            glBindFramebuffer(GL_FRAMEBUFFER, _pool.framebuffer(results[s]));
+            glViewport(0, 0, width, height);
+        }
+
+        // Bind every input; the steps whose result was consumed are tracked for release
+        std::vector<int> consumed;
+        for (std::size_t unit = 0; unit < step.Inputs.size(); ++unit){
+            const std::string& input = step.Inputs[unit];
+            TextureView texture = scene;
+            if (input == "previous" && s > 0){
+                texture = _pool.texture(results[s - 1]);
+                consumed.push_back(static_cast<int>(s - 1));
+            }
+            else{
+                for (std::size_t r = 0; r < s; ++r)
+                    if (!_steps[r].Output.empty() && _steps[r].Output == input){
+                        texture = _pool.texture(results[r]);
+                        consumed.push_back(static_cast<int>(r));
+                    }
+            }
+            glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(unit));
+            texture.bind();
+        }
+        step.Program.use();
+        step.Program.setVector2f("resolution", static_cast<float>(width), static_cast<float>(height));
+        for (int index : step.Passes)
+            if (_passes[index].SetUniforms)
+                _passes[index].SetUniforms(step.Program);
+        RenderStats::drawCall();
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        for (int r : consumed)
+            if (--readers[r] == 0){
+                _pool.release(results[r]);
+                results[r] = -1;
+            }
+    }
+    // Results nobody read (shouldn't happen with a sane chain) still go back to the pool
+    for (std::size_t s = 0; s < _steps.size(); ++s)
+        if (results[s] >= 0)
+            _pool.release(results[s]);
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindFramebuffer(GL_FRAMEBUFFER, Screen::framebuffer());
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
@@ -0,0 +1,90 @@
+//
+//  EffectChain.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "GLResource.hpp"
+#include "RenderTargetPool.hpp"
+#include "Shader.hpp"
+#include "Texture.hpp"
+
+// One pass of an EffectChain.
+// A pixel pass is a GLSL function `vec4 effect(vec4 color, vec2 uv)` that
+// only sees its own pixel; consecutive pixel passes at the same scale are
+// fused into a single shader. A shader pass is a full fragment shader that
+// may sample its inputs anywhere (blurs, downsamples...) and is never fused.
+struct EffectPass {
+    std::string Name;
+    // Exactly one of these: the pixel function file or the fragment shader file
+    const GLchar *PixelFile  = nullptr;
+    const GLchar *ShaderFile = nullptr;
+    // Samplers bound to texture units 0..n, each one named after its input:
+    // "previous" (result of the pass before), "scene" (the chain's input),
+    // or the Output of an earlier pass. Pixel passes only use the first one
+    std::vector<std::string> Inputs = { "previous" };
+    // Names the result so later passes can read it; otherwise it only feeds the next pass
+    std::string Output;
+    // Resolution relative to the scene (the last pass always covers the whole target)
+    float Scale = 1.0f;
+    // Disabled passes are skipped; toggling them re-plans the chain on the next run
+    bool Enabled = true;
+    // Sets the pass's own uniforms every frame. Fused passes share one program,
+    // so their uniform names should be prefixed with the pass name
+    std::function<void(Shader&)> SetUniforms;
+};
+
+// EffectChain runs a list of post-processing passes over the scene.
+// Before running, the enabled passes are planned into steps (fusing
+// compatible pixel passes), and every intermediate result is rendered
+// into a target borrowed from a shared RenderTargetPool and returned as
+// soon as its last reader has run. Programs are compiled once per step.
+class EffectChain{
+public:
+    EffectChain(GLuint width, GLuint height);
+    // Appends a pass to the end of the chain
+    void add(EffectPass pass);
+    // Finds a pass by name (nullptr if missing); valid until the next add()
+    EffectPass* find(const std::string& name);
+    // Whether no pass is enabled
+    bool empty() const;
+    // Runs the enabled passes on scene; the final step draws into targetFramebuffer (usually Screen::framebuffer())
+    void run(TextureView scene, GLuint targetFramebuffer);
+    // Targets shared by the passes (and available to the owner for its own intermediates)
+    RenderTargetPool& pool() { return _pool; }
+    // Programs compiled so far
+    std::size_t programCount() const { return _programs.size(); }
+    // Draws issued per run after fusion
+    std::size_t stepCount() const { return _steps.size(); }
+private:
+    struct Step {
+        std::vector<int>         Passes;  // indices into _passes, fused in order
+        std::vector<std::string> Inputs;
+        std::string              Output;  // empty unless a later step reads it by name
+        float                    Scale;
+        int                      Readers; // later steps reading the result
+        Shader                   Program;
+    };
+    // Groups the enabled passes into steps and compiles their programs
+    void plan();
+    Shader programFor(const Step& step);
+    GLuint _width, _height;
+    std::vector<EffectPass>  _passes;
+    std::vector<std::string> _sources; // per pass, loaded once
+    std::vector<bool>        _planned; // Enabled flags the current plan was built for
+    std::vector<Step>        _steps;
+    std::map<std::string, GLProgram> _programs; // by step signature
+    RenderTargetPool _pool;
+    GLVertexArray    _vao; // empty: the full-screen triangle comes from gl_VertexID
+    std::string      _vertexSource;
+};
@@ -0,0 +1,41 @@
+//
+//  FrameCapture.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "FrameCapture.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "stb_image_write.h"
+#include "Profiler.hpp"
+#include "Screen.hpp"
+
+bool FrameCapture::writePNG(const std::string& file, GLuint framebuffer, int width, int height){
+    PROFILE_SCOPE("FrameCapture::writePNG");
+    // RGB only: the alpha left in the framebuffer by blending is meaningless in a screenshot
+    const int stride = width * 3;
+    std::vector<unsigned char> pixels(static_cast<std::size_t>(stride) * height);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, Screen::framebuffer());
+    // OpenGL rows start at the bottom, PNG rows at the top
+    std::vector<unsigned char> row(stride);
+    for (int y = 0; y < height / 2; ++y){
+        unsigned char* top = pixels.data() + static_cast<std::size_t>(y) * stride;
+        unsigned char* bottom = pixels.data() + static_cast<std::size_t>(height - 1 - y) * stride;
+        std::memcpy(row.data(), top, stride);
+        std::memcpy(top, bottom, stride);
+        std::memcpy(bottom, row.data(), stride);
+    }
+    if (!stbi_write_png(file.c_str(), width, height, 3, pixels.data(), stride)){
+        std::cout << "ERROR::FRAMECAPTURE: Failed to write " << file << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,23 @@
+//
+//  FrameCapture.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <string>
+
+#include <GL/glew.h>
+
+// FrameCapture reads rendered frames back from a framebuffer and writes
+// them as PNG (through the stb_image_write bundled with SOIL2), e.g. for
+// golden-image comparisons of headless runs.
+class FrameCapture{
+public:
+    // Reads width x height pixels of framebuffer and writes them to file (top row first)
+    static bool writePNG(const std::string& file, GLuint framebuffer, int width, int height);
+private:
+    FrameCapture() { }
+};
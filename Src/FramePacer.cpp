@@ -0,0 +1,117 @@
+//
+//  FramePacer.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "FramePacer.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "WindowManager.hpp"
+#include "Profiler.hpp"
+#include "Clock.hpp"
+
+namespace {
+    // Slice slept at a time; short enough that one oversleep costs little
+    const std::chrono::milliseconds SLEEP_SLICE(1);
+    // Assumed cost of a sleep slice until some have been measured (coarse timers round up to ~2ms)
+    const double INITIAL_SLEEP_COST_NS = 2e6;
+    // Samples kept in the sleep cost estimate before it starts over, so it follows changes in system load
+    const uint64_t SLEEP_COST_WINDOW = 1000;
+    // An interval this many target intervals long counts as a missed frame
+    const double MISSED_FRAME_FACTOR = 1.5;
+}
+
+FramePacer::FramePacer(PacingMode mode, double targetFps) : _mode(mode){
+    if (_mode == PacingMode::Capped){
+        if (targetFps > 0.0)
+            _periodNs = static_cast<uint64_t>(1e9 / targetFps);
+        else{
+            std::cout << "ERROR::FRAMEPACER: Invalid frame cap " << targetFps << ", running uncapped" << std::endl;
+            _mode = PacingMode::Uncapped;
+        }
+    }
+}
+
+void FramePacer::configure(WindowManager& window){
+    if (_mode == PacingMode::Adaptive && !window.supportsAdaptiveSync() && !window.isHeadless()){
+        std::cout << "ERROR::FRAMEPACER: Adaptive vsync is not supported, using vsync" << std::endl;
+        _mode = PacingMode::VSync;
+    }
+    if (_mode == PacingMode::VSync || _mode == PacingMode::Adaptive){
+        // The driver paces these; headless there is no display to wait for
+        window.setSwapInterval(_mode == PacingMode::VSync ? 1 : -1);
+        _periodNs = window.isHeadless() ? 0 : static_cast<uint64_t>(1e9 / window.refreshRate());
+    }
+    else
+        window.setSwapInterval(0);
+}
+
+void FramePacer::wait(){
+    PROFILE_SCOPE("FramePacer::wait");
+    if (_mode == PacingMode::Capped){
+        uint64_t now = Clock::now();
+        // First frame, or more than a whole period behind: restart the schedule from now
+        if (_nextDeadline == 0 || now > _nextDeadline + _periodNs)
+            _nextDeadline = now;
+        else
+            waitUntil(_nextDeadline);
+    }
+    uint64_t start = Clock::now();
+    if (_mode == PacingMode::Capped){
+        _wakeLateness.add((start - _nextDeadline) / 1e6);
+        _nextDeadline += _periodNs;
+    }
+    if (_lastStart != 0){
+        uint64_t interval = start - _lastStart;
+        _intervals.add(interval / 1e6);
+        if (_periodNs != 0 && interval > _periodNs * MISSED_FRAME_FACTOR)
+            ++_missed;
+    }
+    _lastStart = start;
+}
+
+void FramePacer::waitUntil(uint64_t deadline){
+    for (;;){
+        uint64_t now = Clock::now();
+        if (now >= deadline)
+            return;
+        double sleepCost = _sleepCost.count() > 1 ? _sleepCost.mean() + _sleepCost.stddev() : INITIAL_SLEEP_COST_NS;
+        if (deadline - now <= sleepCost)
+            break;
+        std::this_thread::sleep_for(SLEEP_SLICE);
+        if (_sleepCost.count() == SLEEP_COST_WINDOW)
+            _sleepCost = RunningStats();
+        _sleepCost.add(static_cast<double>(Clock::now() - now));
+    }
+    // Less than a sleep's worth left: spin on the clock
+    while (Clock::now() < deadline)
+        ;
+}
+
+void FramePacer::report(std::ostream& out) const{
+    out << "Frame pacing (" << modeName(_mode);
+    if (_periodNs != 0)
+        out << ", target " << targetMs() << " ms";
+    out << "): " << _intervals.count() << " intervals, " << _intervals.mean() << " ms (jitter sd " << _intervals.stddev()
+        << ", min " << _intervals.min() << ", max " << _intervals.max() << ")";
+    if (_periodNs != 0)
+        out << ", " << _missed << " missed";
+    if (_mode == PacingMode::Capped)
+        out << ", wake lateness " << _wakeLateness.mean() << " ms (max " << _wakeLateness.max() << ")";
+    out << std::endl;
+}
+
+const char* FramePacer::modeName(PacingMode mode){
+    switch (mode){
+        case PacingMode::VSync:    return "vsync";
+        case PacingMode::Adaptive: return "adaptive vsync";
+        case PacingMode::Capped:   return "capped";
+        case PacingMode::Uncapped: return "uncapped";
+    }
+    return "unknown";
+}
@@ -0,0 +1,70 @@
+//
+//  FramePacer.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+#include "RunningStats.hpp"
+
+class WindowManager;
+
+enum class PacingMode {
+    VSync,      // Swap interval 1: wait for every vblank
+    Adaptive,   // Swap interval -1: vsync, but late frames tear instead of waiting a refresh (vsync if unsupported)
+    Capped,     // No vsync, frames started at a fixed rate by the pacer
+    Uncapped    // No vsync, no waiting (benchmarks)
+};
+
+// FramePacer decides when the main loop starts a frame. The vsync modes
+// leave the waiting to the driver's swap; capped mode waits for the next
+// frame deadline itself, sleeping while the remaining time comfortably
+// exceeds what a sleep costs on this machine, then spinning the rest, so
+// frames start within microseconds of their deadline without burning a
+// core for the whole frame. Deadlines advance by whole periods, so one
+// late frame does not shift the ones after it. Every frame start feeds the
+// frame interval statistics.
+class FramePacer{
+public:
+    // targetFps is used by Capped only
+    FramePacer(PacingMode mode, double targetFps);
+    // Sets the swap interval for the mode. Call once the context is current
+    void configure(WindowManager& window);
+    // Waits for the next frame's start (capped) and records the interval since the previous one
+    void wait();
+    // The loop is idling on events instead of pacing: the next wait() starts a new schedule and
+    // the idle time is not counted as a frame interval
+    void pause() { _nextDeadline = 0; _lastStart = 0; }
+
+    PacingMode mode() const { return _mode; }
+    // Frame interval the mode aims for, in ms (0 when uncapped)
+    double targetMs() const { return _periodNs / 1e6; }
+    // Time between frame starts, in ms
+    const RunningStats& intervals() const { return _intervals; }
+    // How far past its deadline each capped frame started, in ms
+    const RunningStats& wakeLateness() const { return _wakeLateness; }
+    // Frames that took more than one and a half target intervals
+    uint64_t missedFrames() const { return _missed; }
+    // Writes the interval statistics on one line
+    void report(std::ostream& out) const;
+
+    static const char* modeName(PacingMode mode);
+private:
+    // Sleeps, then spins, until Clock::now() reaches deadline
+    void waitUntil(uint64_t deadline);
+
+    PacingMode _mode;
+    uint64_t _periodNs = 0;
+    uint64_t _nextDeadline = 0;
+    uint64_t _lastStart = 0;
+    // Observed length of a 1ms sleep, in ns: the spin phase starts when less than mean + sd of it remains
+    RunningStats _sleepCost;
+    RunningStats _intervals;
+    RunningStats _wakeLateness;
+    uint64_t _missed = 0;
+};
@@ -0,0 +1,212 @@
+//
+//  FrameRecorder.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "FrameRecorder.hpp"
+
+#include <cstring>
+#include <iostream>
+
+#include "stb_image_write.h"
+extern "C" {
+#define JO_JPEG_HEADER_FILE_ONLY
+#include "jo_jpeg.h"
+}
+#include "Profiler.hpp"
+#include "Screen.hpp"
+
+namespace {
+    const int JPEG_QUALITY = 90;
+}
+
+FrameRecorder::FrameRecorder(const std::string& path, RecordFormat format, GLuint width, GLuint height)
+    : _path(path), _format(format), _width(width), _height(height){
+    const GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+    for (Readback& readback : _ring){
+        readback.PBO.generate();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.PBO.get());
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (_format == RecordFormat::Raw){
+        _rawFile = std::fopen(_path.c_str(), "wb");
+        if (!_rawFile)
+            std::cout << "ERROR::FRAMERECORDER: Failed to open " << _path << std::endl;
+    }
+    _encoder = std::thread(&FrameRecorder::encodeLoop, this);
+}
+
+FrameRecorder::~FrameRecorder(){
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _queued.notify_all();
+    _encoder.join();
+    if (_rawFile)
+        std::fclose(_rawFile);
+}
+
+void FrameRecorder::capture(GLuint framebuffer){
+    PROFILE_SCOPE("FrameRecorder::capture");
+    uint64_t frame = _captured++;
+    // Collect finished readbacks, oldest first (_next is the oldest one in flight)
+    for (int i = 0; i < RING_SIZE; ++i){
+        Readback& readback = _ring[(_next + i) % RING_SIZE];
+        if (readback.Fence && !collect(readback, false))
+            break;
+    }
+    Readback& readback = _ring[_next];
+    if (readback.Fence){
+        // The GPU hasn't caught up with the last RING_SIZE readbacks: skip this frame rather than wait
+        ++_droppedReadbacks;
+        return;
+    }
+    // With a pack buffer bound glReadPixels only queues the copy and returns
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.PBO.get());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, Screen::framebuffer());
+    readback.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.Frame = frame;
+    _next = (_next + 1) % RING_SIZE;
+}
+
+void FrameRecorder::finish(){
+    for (int i = 0; i < RING_SIZE; ++i){
+        Readback& readback = _ring[(_next + i) % RING_SIZE];
+        if (readback.Fence)
+            collect(readback, true);
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _drained.wait(lock, [this]{ return _queue.empty() && !_encoding; });
+}
+
+uint64_t FrameRecorder::writtenFrames() const{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _written;
+}
+
+const char* FrameRecorder::formatName(RecordFormat format){
+    switch (format){
+        case RecordFormat::JPEG: return "jpeg";
+        case RecordFormat::PNG:  return "png";
+        case RecordFormat::Raw:  return "raw";
+    }
+    return "";
+}
+
+bool FrameRecorder::collect(Readback& readback, bool wait){
+    GLenum status = glClientWaitSync(readback.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+    glDeleteSync(readback.Fence);
+    readback.Fence = nullptr;
+    if (status == GL_WAIT_FAILED){
+        ++_droppedReadbacks;
+        return true;
+    }
+
+    std::vector<unsigned char> pixels;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_queue.size() >= MAX_QUEUED){
+            ++_droppedEncodes;
+            return true;
+        }
+        if (!_freeBuffers.empty()){
+            pixels = std::move(_freeBuffers.back());
+            _freeBuffers.pop_back();
+        }
+    }
+    const std::size_t size = static_cast<std::size_t>(_width) * _height * 4;
+    pixels.resize(size);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.PBO.get());
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    bool mapped = data != nullptr;
+    if (mapped){
+        std::memcpy(pixels.data(), data, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!mapped){
+        ++_droppedReadbacks;
+        _freeBuffers.push_back(std::move(pixels));
+        return true;
+    }
+    _queue.push_back({ readback.Frame, std::move(pixels) });
+    _queued.notify_one();
+    return true;
+}
+
+void FrameRecorder::encodeLoop(){
+    Profiler::setThreadName("FrameEncoder");
+    std::vector<unsigned char> rgb;
+    for (;;){
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _queued.wait(lock, [this]{ return _stopping || !_queue.empty(); });
+            if (_queue.empty())
+                return;
+            frame = std::move(_queue.front());
+            _queue.pop_front();
+            _encoding = true;
+        }
+        bool written = encode(frame, rgb);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (written)
+                ++_written;
+            _freeBuffers.push_back(std::move(frame.Pixels));
+            _encoding = false;
+        }
+        _drained.notify_all();
+    }
+}
+
+bool FrameRecorder::encode(Frame& frame, std::vector<unsigned char>& rgb){
+    PROFILE_SCOPE("FrameRecorder::encode");
+    // Bottom-up RGBA to top-down RGB: the alpha left by blending is meaningless in a recording
+    const std::size_t stride = static_cast<std::size_t>(_width) * 3;
+    rgb.resize(stride * _height);
+    for (GLuint y = 0; y < _height; ++y){
+        const unsigned char* source = frame.Pixels.data() + static_cast<std::size_t>(_height - 1 - y) * _width * 4;
+        unsigned char* destination = rgb.data() + y * stride;
+        for (GLuint x = 0; x < _width; ++x, source += 4, destination += 3){
+            destination[0] = source[0];
+            destination[1] = source[1];
+            destination[2] = source[2];
+        }
+    }
+
+    bool written = false;
+    char file[32];
+    switch (_format){
+        case RecordFormat::JPEG:
+            std::snprintf(file, sizeof(file), "/frame_%05llu.jpg", static_cast<unsigned long long>(frame.Index));
+            written = jo_write_jpg((_path + file).c_str(), rgb.data(), _width, _height, 3, JPEG_QUALITY) != 0;
+            break;
+        case RecordFormat::PNG:
+            std::snprintf(file, sizeof(file), "/frame_%05llu.png", static_cast<unsigned long long>(frame.Index));
+            written = stbi_write_png((_path + file).c_str(), _width, _height, 3, rgb.data(), static_cast<int>(stride)) != 0;
+            break;
+        case RecordFormat::Raw:
+            written = _rawFile && std::fwrite(rgb.data(), 1, rgb.size(), _rawFile) == rgb.size();
+            break;
+    }
+    // Report the first failure only, a missing directory would fail every frame
+    if (!written && !_reportedFailure){
+        _reportedFailure = true;
+        std::cout << "ERROR::FRAMERECORDER: Failed to write frame " << frame.Index << " to " << _path << std::endl;
+    }
+    return written;
+}
@@ -0,0 +1,104 @@
+//
+//  FrameRecorder.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "GLResource.hpp"
+
+// How recorded frames are written
+enum class RecordFormat {
+    JPEG, // <directory>/frame_<n>.jpg, through the jo_jpeg bundled with SOIL2
+    PNG,  // <directory>/frame_<n>.png, through stb_image_write
+    Raw   // Every frame appended to one file as top-down RGB24
+          // (ffmpeg -f rawvideo -pix_fmt rgb24 -s <w>x<h> -r 60 -i <file> ...)
+};
+
+// FrameRecorder records the presented frames for QA without stalling the
+// game loop. Each frame is read back into one of a ring of pixel buffer
+// objects (the copy runs asynchronously on the GPU) and only mapped a few
+// frames later, once its fence has signalled. Mapped pixels are copied into
+// a queue drained by a background thread that does the encoding.
+// Nothing ever waits: a frame is dropped when every buffer is still in
+// flight or when the encoder has fallen too far behind, and counted so.
+class FrameRecorder{
+public:
+    // path is a directory for JPEG/PNG and a file for Raw
+    FrameRecorder(const std::string& path, RecordFormat format, GLuint width, GLuint height);
+    // Writes out what has been read back so far and stops the encoder
+    ~FrameRecorder();
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // Collects finished readbacks and starts reading back framebuffer.
+    // Call once per frame, after rendering and before presenting
+    void capture(GLuint framebuffer);
+    // Waits for every readback in flight and for the encoder to empty its queue
+    void finish();
+
+    // Frames handed to capture()
+    uint64_t capturedFrames() const { return _captured; }
+    // Frames written by the encoder
+    uint64_t writtenFrames() const;
+    // Frames dropped because every pixel buffer was still in flight
+    uint64_t droppedReadbacks() const { return _droppedReadbacks; }
+    // Frames dropped because the encoder queue was full
+    uint64_t droppedEncodes() const { return _droppedEncodes; }
+
+    static const char* formatName(RecordFormat format);
+private:
+    // Pixel buffers in flight; a readback is mapped up to RING_SIZE - 1 frames later
+    static const int RING_SIZE = 3;
+    // Frames waiting for the encoder before new ones are dropped
+    static const std::size_t MAX_QUEUED = 8;
+    struct Readback {
+        GLBuffer PBO;
+        GLsync   Fence = nullptr;
+        uint64_t Frame = 0;
+    };
+    struct Frame {
+        uint64_t Index;
+        std::vector<unsigned char> Pixels; // Bottom-up RGBA, as read back
+    };
+
+    std::string  _path;
+    RecordFormat _format;
+    GLuint       _width, _height;
+    Readback     _ring[RING_SIZE];
+    int          _next = 0; // Slot the next readback goes to
+    uint64_t     _captured = 0;
+    uint64_t     _droppedReadbacks = 0;
+    uint64_t     _droppedEncodes = 0;
+
+    // Encoder state, shared with the encoder thread
+    mutable std::mutex _mutex;
+    std::condition_variable _queued;
+    std::condition_variable _drained;
+    std::deque<Frame> _queue;
+    std::vector<std::vector<unsigned char>> _freeBuffers; // Recycled pixel storage
+    bool         _stopping = false;
+    bool         _encoding = false;
+    uint64_t     _written = 0;
+    std::FILE*   _rawFile = nullptr;
+    bool         _reportedFailure = false; // Encoder thread only
+    std::thread  _encoder;
+
+    // Maps a signalled readback and queues its pixels (wait: block on the fence)
+    bool collect(Readback& readback, bool wait);
+    void encodeLoop();
+    bool encode(Frame& frame, std::vector<unsigned char>& rgb);
+};
@@ -0,0 +1,60 @@
+//
+//  GLResource.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "GLResource.hpp"
+
+#include <atomic>
+
+namespace {
+    std::atomic<int> liveObjects[static_cast<int>(GLResourceKind::Count)];
+}
+
+GLuint GLResourceStats::generate(GLResourceKind kind){
+    GLuint id = 0;
+    switch (kind){
+        case GLResourceKind::Texture:      glGenTextures(1, &id);      break;
+        case GLResourceKind::Buffer:       glGenBuffers(1, &id);       break;
+        case GLResourceKind::VertexArray:  glGenVertexArrays(1, &id);  break;
+        case GLResourceKind::Framebuffer:  glGenFramebuffers(1, &id);  break;
+        case GLResourceKind::Renderbuffer: glGenRenderbuffers(1, &id); break;
+        case GLResourceKind::Program:      id = glCreateProgram();     break;
+        case GLResourceKind::Query:        glGenQueries(1, &id);       break;
+        default: break;
+    }
+    if (id)
+        ++liveObjects[static_cast<int>(kind)];
+    return id;
+}
+
+void GLResourceStats::destroy(GLResourceKind kind, GLuint id){
+    switch (kind){
+        case GLResourceKind::Texture:      glDeleteTextures(1, &id);      break;
+        case GLResourceKind::Buffer:       glDeleteBuffers(1, &id);       break;
+        case GLResourceKind::VertexArray:  glDeleteVertexArrays(1, &id);  break;
+        case GLResourceKind::Framebuffer:  glDeleteFramebuffers(1, &id);  break;
+        case GLResourceKind::Renderbuffer: glDeleteRenderbuffers(1, &id); break;
+        case GLResourceKind::Program:      glDeleteProgram(id);           break;
+        case GLResourceKind::Query:        glDeleteQueries(1, &id);       break;
+        default: return;
+    }
+    --liveObjects[static_cast<int>(kind)];
+}
+
+void GLResourceStats::adopt(GLResourceKind kind){
+    ++liveObjects[static_cast<int>(kind)];
+}
+
+int GLResourceStats::liveCount(GLResourceKind kind){
+    return liveObjects[static_cast<int>(kind)].load();
+}
+
+int GLResourceStats::totalLiveCount(){
+    int total = 0;
+    for (int i = 0; i < static_cast<int>(GLResourceKind::Count); ++i)
+        total += liveObjects[i].load();
+    return total;
+}
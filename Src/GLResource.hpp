@@ -0,0 +1,85 @@
+//
+//  GLResource.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <GL/glew.h>
+
+// The kinds of OpenGL objects owned through GLResource
+enum class GLResourceKind : int {
+    Texture,
+    Buffer,
+    VertexArray,
+    Framebuffer,
+    Renderbuffer,
+    Program,
+    Query,
+    Count
+};
+
+// Creation/deletion of GL names and the live-object counters backing them.
+// Implemented in GLResource.cpp so the counters live in a single place.
+namespace GLResourceStats {
+    GLuint generate(GLResourceKind kind);
+    void   destroy(GLResourceKind kind, GLuint id);
+    // Adopts a name created elsewhere (e.g. glCreateProgram) into the counters
+    void   adopt(GLResourceKind kind);
+    // Number of live objects of the given kind
+    int    liveCount(GLResourceKind kind);
+    // Number of live objects of every kind; should be zero after shutdown
+    int    totalLiveCount();
+}
+
+// GLResource owns exactly one OpenGL object name. It is move-only:
+// copying would share the name without an owner, so ownership is
+// transferred explicitly and the name is deleted once, on destruction.
+// A default-constructed GLResource owns nothing and makes no GL calls.
+template <GLResourceKind Kind>
+class GLResource{
+public:
+    GLResource() : _id(0) { }
+    // Takes ownership of an already created name
+    explicit GLResource(GLuint id) : _id(id) { if (_id) GLResourceStats::adopt(Kind); }
+    ~GLResource() { reset(); }
+
+    GLResource(const GLResource&) = delete;
+    GLResource& operator=(const GLResource&) = delete;
+    GLResource(GLResource&& other) noexcept : _id(other._id) { other._id = 0; }
+    GLResource& operator=(GLResource&& other) noexcept{
+        if (this != &other){
+            reset();
+            _id = other._id;
+            other._id = 0;
+        }
+        return *this;
+    }
+
+    // Creates the GL object if this handle doesn't own one yet
+    void generate(){
+        if (!_id)
+            _id = GLResourceStats::generate(Kind);
+    }
+    // Deletes the owned GL object (if any)
+    void reset(){
+        if (_id){
+            GLResourceStats::destroy(Kind, _id);
+            _id = 0;
+        }
+    }
+    GLuint get() const { return _id; }
+    explicit operator bool() const { return _id != 0; }
+private:
+    GLuint _id;
+};
+
+using GLTexture      = GLResource<GLResourceKind::Texture>;
+using GLBuffer       = GLResource<GLResourceKind::Buffer>;
+using GLVertexArray  = GLResource<GLResourceKind::VertexArray>;
+using GLFramebuffer  = GLResource<GLResourceKind::Framebuffer>;
+using GLRenderbuffer = GLResource<GLResourceKind::Renderbuffer>;
+using GLProgram      = GLResource<GLResourceKind::Program>;
+using GLQuery        = GLResource<GLResourceKind::Query>;
@@ -0,0 +1,70 @@
+//
+//  GpuProfiler.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "GpuProfiler.hpp"
+
+GpuProfiler::GpuProfiler(){
+    // Timer queries are core since 3.3 (and exposed by Mesa's software rasterisers)
+    _supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+}
+
+bool GpuProfiler::isEnabled() const{
+    return _supported && Profiler::isActive();
+}
+
+void GpuProfiler::beginFrame(){
+    Frame& frame = _frames[_currentFrame];
+    if (frame.Used > 0)
+        collect(frame);
+    frame.Used = 0;
+    _frameActive = isEnabled();
+}
+
+void GpuProfiler::endFrame(){
+    if (_queryActive)
+        endQuery();
+    _frameActive = false;
+    _currentFrame = (_currentFrame + 1) % FRAME_COUNT;
+}
+
+bool GpuProfiler::beginQuery(const char* name){
+    if (!_frameActive || _queryActive)
+        return false;
+    Frame& frame = _frames[_currentFrame];
+    if (frame.Used == frame.Queries.size()){
+        frame.Queries.emplace_back();
+        frame.Queries.back().Object.generate();
+    }
+    Query& query = frame.Queries[frame.Used++];
+    query.Name = name;
+    query.CpuStart = Clock::now();
+    glBeginQuery(GL_TIME_ELAPSED, query.Object.get());
+    _queryActive = true;
+    return true;
+}
+
+void GpuProfiler::endQuery(){
+    if (!_queryActive)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    _queryActive = false;
+}
+
+void GpuProfiler::collect(Frame& frame){
+    // Queries complete in order, so if the last one is available all of them are
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.Queries[frame.Used - 1].Object.get(), GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available){
+        ++_droppedFrames;
+        return;
+    }
+    for (std::size_t i = 0; i < frame.Used; ++i){
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(frame.Queries[i].Object.get(), GL_QUERY_RESULT, &elapsed);
+        Profiler::recordGpu(frame.Queries[i].Name, frame.Queries[i].CpuStart, frame.Queries[i].CpuStart + elapsed);
+    }
+}
@@ -0,0 +1,78 @@
+//
+//  GpuProfiler.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "GLResource.hpp"
+#include "Profiler.hpp"
+
+// GpuProfiler measures GPU time per render pass with GL_TIME_ELAPSED
+// queries. Queries are kept in a ring of frames and only read back once
+// GL_QUERY_RESULT_AVAILABLE says so, a few frames later, so measuring never
+// stalls the pipeline; if results are still not in when a frame's slot is
+// reused they are dropped. Results are reported through Profiler::recordGpu,
+// i.e. the same trace and overlay as the CPU scopes.
+// GL_TIME_ELAPSED queries cannot nest: a query begun while another one is
+// active is ignored, and only the scope that began a query ends it, so a
+// nested scope is counted in the outer one.
+class GpuProfiler{
+public:
+    GpuProfiler();
+    // Measures only while the Profiler is recording and the driver supports timer queries
+    bool isEnabled() const;
+    // Reads back finished frames and starts a new one
+    void beginFrame();
+    void endFrame();
+    // Returns whether a query was started (not while disabled or another query is active)
+    bool beginQuery(const char* name);
+    void endQuery();
+    // Frames whose results were not available in time
+    int droppedFrames() const { return _droppedFrames; }
+
+    // RAII pass timer, use through GPU_PROFILE_SCOPE
+    class ScopedQuery{
+    public:
+        ScopedQuery(GpuProfiler& profiler, const char* name) : _profiler(profiler), _started(profiler.beginQuery(name)) { }
+        ~ScopedQuery() { if (_started) _profiler.endQuery(); }
+        ScopedQuery(const ScopedQuery&) = delete;
+        ScopedQuery& operator=(const ScopedQuery&) = delete;
+    private:
+        GpuProfiler& _profiler;
+        bool _started;
+    };
+private:
+    // Frames in flight before results are read back
+    static const int FRAME_COUNT = 4;
+    struct Query {
+        GLQuery     Object;
+        const char* Name;
+        uint64_t    CpuStart; // When the query was issued, to place it on the trace timeline
+    };
+    struct Frame {
+        std::vector<Query> Queries;
+        std::size_t Used = 0;
+    };
+    void collect(Frame& frame);
+
+    Frame _frames[FRAME_COUNT];
+    int _currentFrame = 0;
+    bool _supported;
+    bool _frameActive = false;
+    bool _queryActive = false;
+    int _droppedFrames = 0;
+};
+
+#if BREAKOUT_PROFILER
+#define GPU_PROFILE_SCOPE(profiler, name) GpuProfiler::ScopedQuery PROFILE_CONCAT(_gpuProfileScope, __LINE__)(profiler, name)
+#else
+#define GPU_PROFILE_SCOPE(profiler, name) ((void)0)
+#endif
@@ -13,9 +13,12 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "InputManager.hpp"
+#include "Clock.hpp"
 #include <algorithm>
+#include <iterator>
 
 std::vector<InputManager*> InputManager::_instances;
+uint64_t InputManager::_lastQueuedTime = 0;
 
 InputManager::InputManager() : _isEnabled(true) {
   // Add this instance to the list of instances
@@ -27,32 +30,34 @@ InputManager::~InputManager() {
   _instances.erase(std::remove(_instances.begin(), _instances.end(), this), _instances.end());
 }
 
-bool InputManager::getIsKeyDown(int key) {
-  bool result = false;
-  if (_isEnabled) {
-    std::map<int,bool>::iterator it = _keys.find(key);
-    if (it != _keys.end()) {
-      result = _keys[key];
+void InputManager::update(uint64_t time) {
+  std::fill(std::begin(_pressed), std::end(_pressed), false);
+  std::fill(std::begin(_released), std::end(_released), false);
+  // Events stamped after time belong to the next tick
+  for (const KeyEvent* event = _events.peek(); event && event->Time <= time; event = _events.peek()) {
+    if (event->Down && !_down[event->Key]) {
+      _pressed[event->Key] = true;
+      _pressTime[event->Key] = event->Time;
     }
+    else if (!event->Down && _down[event->Key])
+      _released[event->Key] = true;
+    _down[event->Key] = event->Down;
+    _lastEventTime = event->Time;
+    _events.pop();
   }
-  return result;
 }
-bool InputManager::getLastKeyDown(int key) {
-  bool result = false;
-  if (_isEnabled) {
-    auto it = _KeyPresses.find(key);
-    if (it != _KeyPresses.end()) {
-      result = _KeyPresses[key].previous;
-    }
-  }
-  return result;
+
+bool InputManager::getIsKeyDown(int key) const {
+  // A key pressed and released within the tick still counts as down for it
+  return _isEnabled && isValid(key) && (_down[key] || _pressed[key]);
 }
 
-void InputManager::setLastKeyDown(int key, bool isDown) {
-  auto it = _keys.find(key);
-  if (it != _keys.end()) {
-    _KeyPresses[key].previous = isDown;
-  }
+bool InputManager::getIsKeyPressed(int key) const {
+  return _isEnabled && isValid(key) && _pressed[key];
+}
+
+bool InputManager::getIsKeyReleased(int key) const {
+  return _isEnabled && isValid(key) && _released[key];
 }
 
 void InputManager::setupKeyInputs(WindowManager& window) {
@@ -61,27 +66,29 @@ void InputManager::setupKeyInputs(WindowManager& window) {
 
 
 void InputManager::callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+  // When a user presses the escape key, we set the WindowShouldClose property to true, closing the application
+  if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+      glfwSetWindowShouldClose(window, GL_TRUE);
+  // Key repeats carry no new state
+  if (!isValid(key) || action == GLFW_REPEAT)
+      return;
+  dispatch({ key, action != GLFW_RELEASE, Clock::now() });
+}
+
+void InputManager::inject(int key, bool down) {
+  if (isValid(key))
+      dispatch({ key, down, Clock::now() });
+}
+
+void InputManager::dispatch(const KeyEvent& event) {
+  _lastQueuedTime = event.Time;
   // Send key event to all InputManager instances
   for (InputManager* InputManager : _instances) {
-      // When a user presses the escape key, we set the WindowShouldClose property to true, closing the application
-      if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
-          glfwSetWindowShouldClose(window, GL_TRUE);
-      
-      InputManager->setIsKeyDown(key, action != GLFW_RELEASE);
-
-//      if (key >= 0 && key < 1024){
-//          if (action == GLFW_PRESS)
-//              Breakout._keysArray[key] = GL_TRUE;
-//          else if (action == GLFW_RELEASE)
-//              Breakout._keysArray[key] = GL_FALSE;
-//      }
+      if (!InputManager->_events.push(event))
+          InputManager->_droppedEvents.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
-void InputManager::setIsKeyDown(int key, bool isDown) {
-    _keys[key] = isDown;
-}
-
 /*
     using Callback = std::function<void()>;
 
@@ -6,15 +6,28 @@
 //  Copyright © 2020 Miguel Lopes. All rights reserved.
 //
 
+#pragma once
+
 #include "WindowManager.hpp"
+#include "SpscQueue.hpp"
 
-#include <map>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
-struct KeyPress {
-    bool current, previous;
+// A key going down or up, stamped with when GLFW reported it (Clock::now())
+struct KeyEvent {
+    int      Key;
+    bool     Down;
+    uint64_t Time;
 };
 
+// InputManager keeps the state of every key in flat arrays indexed by key
+// code. The GLFW callback only queues timestamped events (lock-free, so the
+// simulation may run on another thread); update() applies the events up to
+// a given time once per tick and computes which keys went down/up in it, so
+// input lands on the tick it happened in, and a tap shorter than a tick is
+// still seen as a press.
 class InputManager {
   // Main KeyInput functionality
   public:
@@ -23,29 +36,53 @@ class InputManager {
 
     // Must be called before any KeyInput instances will work
     static void setupKeyInputs(WindowManager& window);
-    
-    /// If this KeyInput is enabled and the given key is monitored, returns pressed state.  Else returns false.
-    bool getIsKeyDown(int key);
-    /// If previous KeyInput was the given key, returns true.
-    bool getLastKeyDown(int key);
-    void setLastKeyDown(int key, bool isDown);
+    // Queues a key event on every instance as if GLFW had reported it now (scripted input, e.g. headless
+    // runs). Call from the main thread: like the callback, it is the only producer of the queues
+    static void inject(int key, bool down);
+    // Time the newest key event was queued, 0 before the first one. Main thread only
+    static uint64_t lastQueuedTime() { return _lastQueuedTime; }
+
+    /// Applies the queued events stamped up to time and computes this tick's edges. Call once per tick
+    void update(uint64_t time);
+    /// If this KeyInput is enabled, returns whether the key is held (or was tapped during the tick).  Else returns false.
+    bool getIsKeyDown(int key) const;
+    /// Whether the key went down during the tick
+    bool getIsKeyPressed(int key) const;
+    /// Whether the key went up during the tick
+    bool getIsKeyReleased(int key) const;
+    /// Time of the event that last pressed the key, 0 if it never was
+    uint64_t getKeyPressTime(int key) const { return isValid(key) ? _pressTime[key] : 0; }
     // See _isEnabled for details
     bool getIsEnabled() { return _isEnabled; }
     void setIsEnabled(bool value) { _isEnabled = value; }
+    // Time of the newest event applied by update(), 0 before the first one
+    uint64_t lastEventTime() const { return _lastEventTime; }
+    // Events lost because the queue was full
+    uint64_t droppedEvents() const { return _droppedEvents.load(std::memory_order_relaxed); }
   private:
-    // Used internally to update key states.  Called by the GLFW callback.
-    void setIsKeyDown(int key, bool isDown);
-    // Map from monitored keyes to their pressed states
-    std::map<int, bool> _keys;
-    std::map<int, KeyPress> _KeyPresses;
+    static const int KEY_COUNT = GLFW_KEY_LAST + 1;
+    // Events between two ticks before new ones are dropped
+    static const std::size_t QUEUE_SIZE = 256;
+    static bool isValid(int key) { return key >= 0 && key < KEY_COUNT; }
+    // Key states as of the last update()
+    bool _down[KEY_COUNT] = {};
+    bool _pressed[KEY_COUNT] = {};
+    bool _released[KEY_COUNT] = {};
+    uint64_t _pressTime[KEY_COUNT] = {};
+    // Written by the GLFW callback (main thread), drained by update()
+    SpscQueue<KeyEvent, QUEUE_SIZE> _events;
+    std::atomic<uint64_t> _droppedEvents{0};
+    uint64_t _lastEventTime = 0;
     // If disabled, KeyInput.getIsKeyDown always returns false
     bool _isEnabled;
 
 
   private:
-    // The GLFW callback for key events.  Sends events to all KeyInput instances
+    // The GLFW callback for key events.  Queues the event on all KeyInput instances
     static void callback(
       GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void dispatch(const KeyEvent& event);
     // Keep a list of all KeyInput instances and notify them all of key events
     static std::vector<InputManager*> _instances;
+    static uint64_t _lastQueuedTime;
 };
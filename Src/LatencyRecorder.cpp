@@ -0,0 +1,55 @@
+//
+//  LatencyRecorder.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "LatencyRecorder.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+    struct Stage {
+        const char* Name;
+        uint64_t InputTrace::*From;
+        uint64_t InputTrace::*To;
+    };
+    const Stage STAGES[] = {
+        { "event -> applied",        &InputTrace::Event,     &InputTrace::Applied },
+        { "applied -> moved",        &InputTrace::Applied,   &InputTrace::Moved },
+        { "moved -> submitted",      &InputTrace::Moved,     &InputTrace::Submitted },
+        { "submitted -> presented",  &InputTrace::Submitted, &InputTrace::Presented },
+        { "event -> presented",      &InputTrace::Event,     &InputTrace::Presented },
+    };
+
+    double percentile(const std::vector<double>& sorted, double fraction){
+        std::size_t index = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+}
+
+void LatencyRecorder::report(std::ostream& out) const{
+    if (_traces.empty())
+        return;
+    out << "Input latency over " << _traces.size() << " paddle moves (ms):     p50     p90     p99     max" << std::endl;
+    std::vector<double> samples;
+    samples.reserve(_traces.size());
+    out << std::fixed << std::setprecision(2);
+    for (const Stage& stage : STAGES){
+        samples.clear();
+        for (const InputTrace& trace : _traces)
+            if (trace.*stage.To >= trace.*stage.From)
+                samples.push_back((trace.*stage.To - trace.*stage.From) / 1e6);
+        if (samples.empty())
+            continue;
+        std::sort(samples.begin(), samples.end());
+        out << "  " << std::left << std::setw(38) << stage.Name << std::right
+            << std::setw(8) << percentile(samples, 0.5)
+            << std::setw(8) << percentile(samples, 0.9)
+            << std::setw(8) << percentile(samples, 0.99)
+            << std::setw(8) << samples.back() << std::endl;
+    }
+    out << std::defaultfloat << std::setprecision(6);
+}
@@ -0,0 +1,36 @@
+//
+//  LatencyRecorder.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// One key press followed until the frame showing its effect was presented.
+// Times come from Clock::now(); a stage not reached yet is 0
+struct InputTrace {
+    uint64_t Event = 0;     // InputManager::callback received the key event
+    uint64_t Applied = 0;   // The tick (or late latch) that applied it started
+    uint64_t Moved = 0;     // The paddle moved because of it
+    uint64_t Submitted = 0; // The frame drawing that move was submitted
+    uint64_t Presented = 0; // glfwSwapBuffers returned for that frame
+};
+
+// LatencyRecorder collects finished input traces and reports the
+// distribution of each stage and of the whole input-to-present delay.
+// Presenting is as far as the application can see: the display adds up to
+// one refresh of scanout on top.
+class LatencyRecorder{
+public:
+    void add(const InputTrace& trace) { _traces.push_back(trace); }
+    std::size_t count() const { return _traces.size(); }
+    // Writes p50/p90/p99/max per stage, in ms
+    void report(std::ostream& out) const;
+private:
+    std::vector<InputTrace> _traces;
+};
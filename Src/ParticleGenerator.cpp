@@ -7,14 +7,16 @@
 //
 
 #include "ParticleGenerator.hpp"
-ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, GLuint amount)
+#include "RenderStats.hpp"
+ParticleGenerator::ParticleGenerator(Shader shader, TextureView texture, GLuint amount)
     : shader(shader), texture(texture), amount(amount){
-    init();
+    // Create amount default particle instances
+    for (GLuint i = 0; i < amount; ++i)//TODO: JobSystem and decent ObjectPool
+        particles.push_back(Particle());
 }
 
 void ParticleGenerator::init(){
     // Set up mesh and attribute properties
-    GLuint VBO;
     float particle_quad[] = {
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f,
@@ -24,20 +26,16 @@ void ParticleGenerator::init(){
         1.0f, 1.0f, 1.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f
     };
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
+    VAO.generate();
+    VBO.generate();
+    glBindVertexArray(VAO.get());
     // Fill mesh buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
     glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
     // Set mesh attributes
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (GLvoid*)0);
     glBindVertexArray(0);
-
-    // Create amount default particle instances
-    for (GLuint i = 0; i < amount; ++i)//TODO: JobSystem and decent ObjectPool
-        particles.push_back(Particle());
 }
 
 //Then in each frame, we spawn several new particles with starting values
@@ -59,26 +57,42 @@ void ParticleGenerator::update(float dt, GameObject &object, GLuint newParticles
     }
 }
 
+void ParticleGenerator::collect(std::vector<Particle>& live) const{
+    live.clear();
+    for (const Particle& particle : particles)
+        if (particle.Life > 0.0f)
+            live.push_back(particle);
+}
+
 // Render all particles
-void ParticleGenerator::draw(){
+void ParticleGenerator::draw(const std::vector<Particle>& live){
+    if (!VAO.get())
+        init();
     // Use additive blending (GL_ONE)to give it a 'glow' effect
     glBlendFunc(GL_SRC_ALPHA, GL_ONE);
     shader.use();
-    for (Particle particle : particles){
-        if (particle.Life > 0.0f){
-            shader.setVector2f("offset", particle.Position);
-            shader.setVector4f("color", particle.Color);
-            texture.bind();
-            glBindVertexArray(VAO);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
-        }
+    for (const Particle& particle : live){
+        shader.setVector2f("offset", particle.Position);
+        shader.setVector4f("color", particle.Color);
+        texture.bind();
+        glBindVertexArray(VAO.get());
+        RenderStats::drawCall();
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        glBindVertexArray(0);
     }
     // Don't forget to reset to default blending mode
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 
+int ParticleGenerator::liveCount() const{
+    int count = 0;
+    for (const Particle& particle : particles)
+        if (particle.Life > 0.0f)
+            ++count;
+    return count;
+}
+
 // Stores the index of the last particle used (for quick access to next dead particle)
 GLuint lastUsedParticle = 0;//TODO: check this
 GLuint ParticleGenerator::firstUnusedParticle(){//TODO: have a another structure for unusedParticles.
@@ -12,6 +12,7 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include "GLResource.hpp"
 #include "Shader.hpp"
 #include "Texture.hpp"
 #include "GameObject.hpp"
@@ -32,12 +33,17 @@ struct Particle {
 // them after a given amount of time.
 class ParticleGenerator{
 public:
-    // Constructor
-    ParticleGenerator(Shader shader, Texture2D texture, GLuint amount);
+    // Constructor. The GL objects are only created by the first draw(), so the particles can be
+    // simulated without a GL context (e.g. in benchmarks)
+    ParticleGenerator(Shader shader, TextureView texture, GLuint amount);
     // Update all particles
     void update(float dt, GameObject &object, GLuint newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
-    // Render all particles
-    void draw();
+    // Copies the particles currently alive into live (e.g. for a render snapshot)
+    void collect(std::vector<Particle>& live) const;
+    // Render the given particles (as collected)
+    void draw(const std::vector<Particle>& live);
+    // Number of particles currently alive
+    int liveCount() const;
 private:
     // State
     std::vector<Particle> particles;
@@ -45,8 +51,9 @@ private:
     
     // Render state
     Shader shader;
-    Texture2D texture;
-    GLuint VAO;
+    TextureView texture;
+    GLVertexArray VAO;
+    GLBuffer VBO;
     
     // Initializes buffer and vertex attributes
     void init();
@@ -7,38 +7,62 @@
 //
 
 #include "PostProcessor.hpp"
+#include "RenderStats.hpp"
+#include "Screen.hpp"
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <iomanip>
 
-PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height)
-    : PostProcessingShader(shader), Texture(), Width(width), Height(height), Confuse(GL_FALSE), Chaos(GL_FALSE), Shake(GL_FALSE){
-    // Initialize renderbuffer/framebuffer object
-    glGenFramebuffers(1, &MSFBO);
-    glGenFramebuffers(1, &FBO);
-    glGenRenderbuffers(1, &RBO);
-        
-    //Find the max GL_MAX_SAMPLES or else it will crash
-    GLint max_samples;
-    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+namespace {
+    // Bits of a shader variant key, in the order of the #defines passed to ShaderVariants
+    enum EffectBits : uint32_t {
+        EFFECT_CHAOS   = 1 << 0,
+        EFFECT_CONFUSE = 1 << 1,
+        EFFECT_SHAKE   = 1 << 2,
+        EFFECT_FXAA    = 1 << 3,
+        EFFECT_ALL     = (1 << 4) - 1
+    };
+
+    // GLSL literal for a float or vecN, e.g. vec2(0.00333333, 0.00000000)
+    std::string glslValue(const float* values, int components){
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(8);
+        if (components > 1)
+            out << "vec" << components << "(";
+        for (int c = 0; c < components; ++c)
+            out << (c ? ", " : "") << values[c];
+        if (components > 1)
+            out << ")";
+        return out.str();
+    }
+
+    // GLSL array constructor, e.g. float[2](1.00000000, 0.50000000)
+    std::string glslArray(const char* type, const float* values, int count, int components){
+        std::string array = std::string(type) + "[" + std::to_string(count) + "](";
+        for (int i = 0; i < count; ++i)
+            array += (i ? ", " : "") + glslValue(values + i * components, components);
+        return array + ")";
+    }
+}
+
+PostProcessor::PostProcessor(const GLchar *vShaderFile, const GLchar *fShaderFile, GLuint width, GLuint height)
+    : Variants(vShaderFile, fShaderFile, { "CHAOS", "CONFUSE", "SHAKE", "FXAA" }), Chain(width, height), Texture(), Width(width), Height(height), SceneWidth(width), SceneHeight(height), Confuse(GL_FALSE), Chaos(GL_FALSE), Shake(GL_FALSE), FXAA(GL_FALSE), Samples(0), Bypassed(false){
+    // Initialize framebuffer object; the multisampled one is set up by setSamples
+    FBO.generate();
     
-    // Initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
-    glBindFramebuffer(GL_FRAMEBUFFER, MSFBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, RBO);
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, max_samples, GL_RGB, width, height); // Allocate storage for render buffer object
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, RBO); // Attach MS render buffer object to framebuffer
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
-        
-    // Also initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
-    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    // Initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO.get());
     Texture.generate(width, height, NULL);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Texture.ID, 0); // Attach texture to framebuffer as its color attachment
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Texture.getID(), 0); // Attach texture to framebuffer as its color attachment
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, Screen::framebuffer());
+    // Multisample at the maximum the driver allows unless configured otherwise
+    setSamples(-1);
     
-    // Initialize render data and uniforms
+    // Initialize render data and the constants baked into every shader variant
     initRenderData();
-        PostProcessingShader.setInteger("scene", 0, GL_TRUE);
     float offset = 1.0f / 300.0f;
     float offsets[9][2] = {
         { -offset,  offset  },  // top-left
@@ -51,53 +75,156 @@ PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height)
         {  0.0f,   -offset  },  // bottom-center
         {  offset, -offset  }   // bottom-right
     };
-    glUniform2fv(glGetUniformLocation(PostProcessingShader.ID, "offsets"), 9, (float*)offsets);
-    GLint edge_kernel[9] = {
+    float edge_kernel[9] = {
         -1, -1, -1,
         -1,  8, -1,
         -1, -1, -1
     };
-    glUniform1iv(glGetUniformLocation(PostProcessingShader.ID, "edge_kernel"), 9, edge_kernel);
     float blur_kernel[9] = {
         1.0 / 16, 2.0 / 16, 1.0 / 16,
         2.0 / 16, 4.0 / 16, 2.0 / 16,
         1.0 / 16, 2.0 / 16, 1.0 / 16
     };
-    glUniform1fv(glGetUniformLocation(PostProcessingShader.ID, "blur_kernel"), 9, blur_kernel);
+    float texelSize[2] = { 1.0f / width, 1.0f / height };
+    Variants.setCommonDefines("#define OFFSETS "     + glslArray("vec2",  &offsets[0][0], 9, 2) + "\n"
+                            + "#define EDGE_KERNEL " + glslArray("float", edge_kernel, 9, 1) + "\n"
+                            + "#define BLUR_KERNEL " + glslArray("float", blur_kernel, 9, 1) + "\n"
+                            + "#define TEXEL_SIZE "  + glslValue(texelSize, 2) + "\n");
+    // Compile every combination the game can reach now rather than when an effect first starts
+    // mid-game (Chaos+Confuse never is: it uses the Chaos variant). With a warm ProgramCache this
+    // only loads binaries
+    for (uint32_t key = 0; key <= EFFECT_ALL; ++key)
+        if (!((key & EFFECT_CHAOS) && (key & EFFECT_CONFUSE)))
+            variant(key);
+}
+
+void PostProcessor::setSamples(GLint samples){
+    //Find the max GL_MAX_SAMPLES or else it will crash
+    GLint max_samples;
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    if (samples < 0 || samples > max_samples)
+        samples = max_samples;
+    if (samples == Samples && (samples == 0 || RBO))
+        return;
+    Samples = samples;
+    if (Samples == 0){
+        // Render straight into the texture FBO; free the multisampled storage
+        RBO.reset();
+        MSFBO.reset();
+        return;
+    }
+    // Initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
+    MSFBO.generate();
+    RBO.generate();
+    glBindFramebuffer(GL_FRAMEBUFFER, MSFBO.get());
+    glBindRenderbuffer(GL_RENDERBUFFER, RBO.get());
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, Samples, GL_RGB, Width, Height); // Allocate storage for render buffer object
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, RBO.get()); // Attach MS render buffer object to framebuffer
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, Screen::framebuffer());
+}
+
+void PostProcessor::setScale(float scale){
+    Scale = std::min(std::max(scale, MIN_SCALE), 1.0f);
 }
 
 void PostProcessor::beginRender(){
-    glBindFramebuffer(GL_FRAMEBUFFER, MSFBO);
+    // Decided once per frame, so toggling an effect mid-frame can't mismatch begin/end.
+    // Switching paths only rebinds framebuffers that already exist, so it can't hitch
+    bool scaled = Scale < 1.0f;
+    Bypassed = !Confuse && !Chaos && !Shake && !FXAA && Chain.empty() && !scaled;
+    if (Bypassed)
+        glBindFramebuffer(GL_FRAMEBUFFER, Samples > 0 ? MSFBO.get() : Screen::framebuffer());
+    else
+        glBindFramebuffer(GL_FRAMEBUFFER, Samples > 0 ? MSFBO.get() : FBO.get());
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
+    SceneWidth = scaled ? std::max(1u, static_cast<GLuint>(Width * Scale + 0.5f)) : Width;
+    SceneHeight = scaled ? std::max(1u, static_cast<GLuint>(Height * Scale + 0.5f)) : Height;
+    if (scaled){
+        // The scene's projection maps onto whatever viewport is set, so only the viewport shrinks
+        glGetIntegerv(GL_VIEWPORT, Viewport);
+        glViewport(0, 0, SceneWidth, SceneHeight);
+    }
 }
 
 void PostProcessor::endRender(){
-    // Now resolve multisampled color-buffer into intermediate FBO to store to texture
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, MSFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBO);
-    glBlitFramebuffer(0, 0, Width, Height, 0, 0, Width, Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0); // Binds both READ and WRITE framebuffer to default framebuffer
+    if (SceneWidth != Width || SceneHeight != Height)
+        glViewport(Viewport[0], Viewport[1], Viewport[2], Viewport[3]);
+    if (Samples == 0){
+        // Already rendered into the texture (or the screen), nothing to resolve
+        glBindFramebuffer(GL_FRAMEBUFFER, Screen::framebuffer());
+        return;
+    }
+    // Now resolve multisampled color-buffer into intermediate FBO to store to texture,
+    // or straight onto the screen when no effect needs the texture
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, MSFBO.get());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, Bypassed ? Screen::framebuffer() : FBO.get());
+    glBlitFramebuffer(0, 0, SceneWidth, SceneHeight, 0, 0, SceneWidth, SceneHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, Screen::framebuffer()); // Binds both READ and WRITE framebuffer to the screen
 }
 
 void PostProcessor::render(float time){
-    // Set uniforms/options
-    PostProcessingShader.use();
-    PostProcessingShader.setFloat("time", time);
-    PostProcessingShader.setInteger("confuse", Confuse);
-    PostProcessingShader.setInteger("chaos", Chaos);
-    PostProcessingShader.setInteger("shake", Shake);
+    // Without effects the scene is already on screen
+    if (Bypassed)
+        return;
+    if (Chain.empty()){
+        drawEffects(time);
+        return;
+    }
+    if (!Confuse && !Chaos && !Shake && !FXAA && SceneWidth == Width && SceneHeight == Height){
+        // The built-in pass would only copy the scene: feed it to the chain directly
+        Chain.run(Texture.view(), Screen::framebuffer());
+        return;
+    }
+    // Built-in effects (and the upscale) into a pooled target, then the chain on top of them
+    int target = Chain.pool().acquire(Width, Height);
+    glBindFramebuffer(GL_FRAMEBUFFER, Chain.pool().framebuffer(target));
+    glClear(GL_COLOR_BUFFER_BIT); // Shake moves the quad, exposing the target's previous contents
+    drawEffects(time);
+    Chain.run(Chain.pool().texture(target), Screen::framebuffer());
+    Chain.pool().release(target);
+}
+
+void PostProcessor::drawEffects(float time){
+    // The effects are compiled into the variant; only time and the scene's scale change per frame
+    Shader shader = currentShader();
+    shader.use();
+    shader.setFloat("time", time);
+    shader.setVector2f("sceneScale", static_cast<float>(SceneWidth) / Width, static_cast<float>(SceneHeight) / Height);
     // Render textured quad
     glActiveTexture(GL_TEXTURE0);
     Texture.bind();
-    glBindVertexArray(VAO);
+    glBindVertexArray(VAO.get());
+    RenderStats::drawCall();
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
 }
 
+Shader PostProcessor::currentShader(){
+    uint32_t key = 0;
+    if (Chaos)
+        key |= EFFECT_CHAOS;
+    else if (Confuse) // Chaos takes precedence, so Chaos+Confuse shares the Chaos variant
+        key |= EFFECT_CONFUSE;
+    if (Shake)
+        key |= EFFECT_SHAKE;
+    if (FXAA)
+        key |= EFFECT_FXAA;
+    return variant(key);
+}
+
+Shader PostProcessor::variant(uint32_t key){
+    bool isNew = false;
+    Shader shader = Variants.get(key, &isNew);
+    if (isNew)
+        shader.setInteger("scene", 0, GL_TRUE);
+    return shader;
+}
+
 void PostProcessor::initRenderData(){
     // Configure VAO/VBO
-    GLuint VBO;
     float vertices[] = {
         // Pos        // Tex
         -1.0f, -1.0f, 0.0f, 0.0f,
@@ -108,13 +235,13 @@ void PostProcessor::initRenderData(){
          1.0f, -1.0f, 1.0f, 0.0f,
          1.0f,  1.0f, 1.0f, 1.0f
     };
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+    VAO.generate();
+    VBO.generate();
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-    glBindVertexArray(VAO);
+    glBindVertexArray(VAO.get());
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GL_FLOAT), (GLvoid*)0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
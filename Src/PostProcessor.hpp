@@ -11,38 +11,88 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include "GLResource.hpp"
 #include "Texture.hpp"
 #include "SpriteRenderer.hpp"
 #include "Shader.hpp"
+#include "ShaderVariants.hpp"
+#include "EffectChain.hpp"
 
 
 // PostProcessor hosts all PostProcessing effects for the Breakout
 // Game. It renders the game on a textured quad after which one can
 // enable specific effects by enabling either the Confuse, Chaos or
 // Shake boolean.
+// Anti-aliasing is configurable: the scene can be rendered into a
+// multisampled buffer (resolved with a blit), and/or smoothed by a
+// cheap FXAA pass folded into the post-processing shader.
+// While no effect is enabled the offscreen texture and full-screen pass
+// are bypassed: the scene is drawn (or resolved) directly to the screen.
+// Every combination of effects gets its own specialised shader variant
+// (all compiled up front, so turning an effect on never compiles), with
+// the kernels baked in as constants, so the shaders never branch on the
+// enabled effects at runtime.
+// Extra effects (colour grading, scanlines...) are stacked on top through
+// the EffectChain, which runs after the built-in effects.
+// The scene can be rendered at a lower internal resolution (dynamic
+// resolution): it is drawn into the lower-left part of the offscreen
+// targets and upscaled by the built-in pass, so scaling never reallocates.
 // It is required to call BeginRender() before rendering the game
 // and EndRender() after rendering the game for the class to work.
 class PostProcessor{
 public:
-    PostProcessor(Shader shader, GLuint width, GLuint height);
+    PostProcessor(const GLchar *vShaderFile, const GLchar *fShaderFile, GLuint width, GLuint height);
     // Prepares the postprocessor's framebuffer operations before rendering the game
     void beginRender();
     // Should be called after rendering the game, so it stores all the rendered data into a texture object
     void endRender();
-    // Renders the PostProcessor texture quad (as a screen-encompassing large sprite)
+    // Renders the PostProcessor texture quad (as a screen-encompassing large sprite). time drives the
+    // shake/chaos animations, which repeat every 2*pi seconds: pass it wrapped (Clock::phase with
+    // Clock::EFFECT_PERIOD_NS) so it stays precise
     void render(float time);
+    // Sets the MSAA sample count: 0 disables multisampling (no resolve blit), a negative
+    // value or anything above GL_MAX_SAMPLES uses the maximum the driver allows
+    void setSamples(GLint samples);
+    GLint getSamples() const { return Samples; }
+    // Whether the current frame skips the offscreen texture and post-processing pass
+    bool isBypassed() const { return Bypassed; }
+    // Sets the scene's internal resolution relative to the window size, clamped to [MIN_SCALE, 1].
+    // Takes effect on the next beginRender()
+    void setScale(float scale);
+    float getScale() const { return Scale; }
+    static constexpr float MIN_SCALE = 0.25f;
+    // Number of effect combinations compiled so far
+    std::size_t variantCount() const { return Variants.size(); }
+    // Passes applied after the built-in effects
+    EffectChain& chain() { return Chain; }
     // Options
     bool Confuse, Chaos, Shake;
+    // Applies FXAA while drawing the post-processing quad
+    bool FXAA;
 private:
     // Initialize quad for rendering postprocessing texture
     void initRenderData();
+    // Returns the shader variant matching the enabled effects
+    Shader currentShader();
+    // Returns the variant for an EffectBits key, compiling it if needed
+    Shader variant(uint32_t key);
+    // Draws the scene texture through the built-in effects into the bound framebuffer
+    void drawEffects(float time);
     // State
-    Shader PostProcessingShader;
+    ShaderVariants Variants;
+    EffectChain Chain;
     Texture2D Texture;
     // State
     GLuint Width, Height;
+    GLint Samples;
+    bool Bypassed;
+    // Dynamic resolution: requested scale, and the scene size used by the current frame
+    float Scale = 1.0f;
+    GLuint SceneWidth, SceneHeight;
+    GLint Viewport[4]; // Caller's viewport, restored after rendering the scaled scene
     // Render state
-    GLuint MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
-    GLuint RBO; // RBO is used for multisampled color buffer
-    GLuint VAO;
+    GLFramebuffer MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
+    GLRenderbuffer RBO; // RBO is used for multisampled color buffer
+    GLVertexArray VAO;
+    GLBuffer VBO;
 };
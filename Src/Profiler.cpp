@@ -0,0 +1,162 @@
+//
+//  Profiler.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    // Events kept per thread; older events are overwritten once the ring is full
+    const uint64_t RING_CAPACITY = 1 << 16;
+    // Distinct scope names tracked per frame
+    const int MAX_SCOPE_TOTALS = 64;
+
+    struct ThreadBuffer {
+        std::atomic<uint64_t> Head{0}; // Total number of events ever written
+        ProfileEvent Events[RING_CAPACITY];
+        uint32_t ThreadId = 0;
+        std::string Name;
+        // Per-frame totals, only touched by the owning thread
+        ScopeTotal CurrentTotals[MAX_SCOPE_TOTALS];
+        int CurrentCount = 0;
+        std::vector<ScopeTotal> LastTotals;
+    };
+
+    // Buffers outlive their threads so a trace can still be exported after they exit
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+    thread_local ThreadBuffer* localBuffer = nullptr;
+    // Track for GPU scopes; only written by the thread owning the GL context
+    ThreadBuffer* gpuBuffer = nullptr;
+
+    ThreadBuffer& threadBuffer(){
+        if (!localBuffer){
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.push_back(std::make_unique<ThreadBuffer>());
+            localBuffer = registry.back().get();
+            localBuffer->ThreadId = static_cast<uint32_t>(registry.size());
+        }
+        return *localBuffer;
+    }
+
+    void appendEvent(ThreadBuffer& buffer, const char* name, uint64_t start, uint64_t end){
+        // Each buffer has a single writer, so a relaxed load of its own head is enough
+        uint64_t head = buffer.Head.load(std::memory_order_relaxed);
+        buffer.Events[head % RING_CAPACITY] = { name, start, end };
+        buffer.Head.store(head + 1, std::memory_order_release);
+    }
+
+    void addToTotals(ThreadBuffer& buffer, const char* name, uint64_t duration){
+        // Names are static strings, so comparing pointers is enough
+        int i = 0;
+        while (i < buffer.CurrentCount && buffer.CurrentTotals[i].Name != name)
+            ++i;
+        if (i == buffer.CurrentCount){
+            if (i == MAX_SCOPE_TOTALS)
+                return;
+            buffer.CurrentTotals[buffer.CurrentCount++] = { name, 0, 0 };
+        }
+        buffer.CurrentTotals[i].Total += duration;
+        ++buffer.CurrentTotals[i].Calls;
+    }
+
+    void writeEscaped(std::ofstream& out, const char* text){
+        for (; *text; ++text){
+            if (*text == '"' || *text == '\\')
+                out << '\\';
+            out << *text;
+        }
+    }
+}
+
+std::atomic<bool> Profiler::_enabled(false);
+std::atomic<bool> Profiler::_statsEnabled(false);
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end){
+    ThreadBuffer& buffer = threadBuffer();
+    if (isEnabled())
+        appendEvent(buffer, name, start, end);
+    if (isStatsEnabled())
+        addToTotals(buffer, name, end - start);
+}
+
+void Profiler::recordGpu(const char* name, uint64_t start, uint64_t end){
+    if (!gpuBuffer){
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<ThreadBuffer>());
+        gpuBuffer = registry.back().get();
+        gpuBuffer->ThreadId = static_cast<uint32_t>(registry.size());
+        gpuBuffer->Name = "GPU";
+    }
+    // Trace events go to the GPU track, frame totals to the calling thread
+    if (isEnabled())
+        appendEvent(*gpuBuffer, name, start, end);
+    if (isStatsEnabled())
+        addToTotals(threadBuffer(), name, end - start);
+}
+
+void Profiler::endFrame(){
+    ThreadBuffer& buffer = threadBuffer();
+    buffer.LastTotals.assign(buffer.CurrentTotals, buffer.CurrentTotals + buffer.CurrentCount);
+    buffer.CurrentCount = 0;
+}
+
+std::vector<ScopeTotal> Profiler::lastFrameTotals(){
+    return threadBuffer().LastTotals;
+}
+
+void Profiler::setThreadName(const char* name){
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer.Name = name;
+}
+
+bool Profiler::writeChromeTrace(const std::string& file){
+    std::ofstream out(file, std::ios::trunc);
+    if (!out)
+        return false;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    // Find the earliest event so the trace starts at zero
+    uint64_t origin = UINT64_MAX;
+    for (auto& buffer : registry){
+        uint64_t head = buffer->Head.load(std::memory_order_acquire);
+        uint64_t first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+        for (uint64_t i = first; i < head; ++i)
+            origin = std::min(origin, buffer->Events[i % RING_CAPACITY].Start);
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool firstEvent = true;
+    for (auto& buffer : registry){
+        if (!buffer->Name.empty()){
+            out << (firstEvent ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << buffer->ThreadId << ",\"args\":{\"name\":\"";
+            writeEscaped(out, buffer->Name.c_str());
+            out << "\"}}";
+            firstEvent = false;
+        }
+        uint64_t head = buffer->Head.load(std::memory_order_acquire);
+        uint64_t first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+        for (uint64_t i = first; i < head; ++i){
+            const ProfileEvent& event = buffer->Events[i % RING_CAPACITY];
+            out << (firstEvent ? "" : ",") << "\n{\"name\":\"";
+            writeEscaped(out, event.Name);
+            // Chrome trace timestamps are in microseconds
+            out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ThreadId
+                << ",\"ts\":" << (event.Start - origin) / 1000.0
+                << ",\"dur\":" << (event.End - event.Start) / 1000.0 << "}";
+            firstEvent = false;
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,86 @@
+//
+//  Profiler.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Clock.hpp"
+
+// Set BREAKOUT_PROFILER to 0 to compile every PROFILE_SCOPE out of the game
+#ifndef BREAKOUT_PROFILER
+#define BREAKOUT_PROFILER 1
+#endif
+
+// Time spent in one named scope during a frame
+struct ScopeTotal {
+    const char* Name;
+    uint64_t    Total; // ns
+    uint32_t    Calls;
+};
+
+// A single timed scope. Names must be string literals (or otherwise outlive the profiler)
+struct ProfileEvent {
+    const char* Name;
+    uint64_t    Start; // ns
+    uint64_t    End;   // ns
+};
+
+// Lightweight CPU instrumentation. Each thread records its scopes into its
+// own fixed-size ring buffer (single producer, no locks on the hot path),
+// and the whole session can be exported as Chrome trace JSON, which opens
+// in chrome://tracing or ui.perfetto.dev.
+class Profiler{
+public:
+    // Recording can be switched on/off at runtime (it starts disabled)
+    static void setEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+    // Per-frame scope totals (used by the debug overlay) can be collected without recording a trace
+    static void setStatsEnabled(bool enabled) { _statsEnabled.store(enabled, std::memory_order_relaxed); }
+    static bool isStatsEnabled() { return _statsEnabled.load(std::memory_order_relaxed); }
+    static bool isActive() { return isEnabled() || isStatsEnabled(); }
+    // Records a finished scope for the calling thread
+    static void record(const char* name, uint64_t start, uint64_t end);
+    // Records a scope measured on the GPU (start is the CPU time it was issued at). It is exported
+    // on a separate "GPU" track and added to the calling thread's frame totals
+    static void recordGpu(const char* name, uint64_t start, uint64_t end);
+    // Names the calling thread in exported traces
+    static void setThreadName(const char* name);
+    // Closes the calling thread's frame: its scope totals become available through lastFrameTotals()
+    static void endFrame();
+    // Scope totals of the calling thread's last completed frame
+    static std::vector<ScopeTotal> lastFrameTotals();
+    // Writes every recorded event as Chrome trace JSON
+    static bool writeChromeTrace(const std::string& file);
+
+    // RAII scope timer, use through PROFILE_SCOPE
+    class ScopedTimer{
+    public:
+        explicit ScopedTimer(const char* name) : _name(name), _start(isActive() ? Clock::now() : 0) { }
+        ~ScopedTimer() { if (_start) record(_name, _start, Clock::now()); }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    private:
+        const char* _name;
+        uint64_t    _start;
+    };
+private:
+    Profiler() { }
+    static std::atomic<bool> _enabled;
+    static std::atomic<bool> _statsEnabled;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#if BREAKOUT_PROFILER
+#define PROFILE_SCOPE(name) Profiler::ScopedTimer PROFILE_CONCAT(_profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,139 @@
+//
+//  ProgramCache.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "ProgramCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <sys/stat.h>
+
+namespace {
+    const char CACHE_MAGIC[4] = { 'B', 'K', 'P', 'B' };
+
+    // Header stored in front of every program binary
+    struct ProgramBinaryHeader {
+        char     Magic[4];
+        uint32_t Format;
+        uint64_t Key;
+    };
+
+    // 64-bit FNV-1a, chained through seed
+    uint64_t hashBytes(const void* data, std::size_t size, uint64_t seed){
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i){
+            seed ^= bytes[i];
+            seed *= 1099511628211ull;
+        }
+        return seed;
+    }
+
+    uint64_t hashString(const char* string, uint64_t seed){
+        // Hash the terminator too, so ("ab","c") and ("a","bc") differ
+        return string ? hashBytes(string, std::strlen(string) + 1, seed) : hashBytes("", 1, seed);
+    }
+}
+
+std::string ProgramCache::_directory = "ShaderCache";
+int ProgramCache::_enabled = -1;
+int ProgramCache::_hits = 0;
+int ProgramCache::_misses = 0;
+
+void ProgramCache::setDirectory(const std::string& directory){
+    _directory = directory;
+}
+
+void ProgramCache::setEnabled(bool enabled){
+    _enabled = enabled ? -1 : 0;
+}
+
+bool ProgramCache::isEnabled(){
+    if (_enabled < 0){
+        // Drivers without any binary format (or without the extension) can't cache
+        GLint formats = 0;
+        if (GLEW_ARB_get_program_binary || GLEW_VERSION_4_1)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        _enabled = formats > 0 ? 1 : 0;
+    }
+    return _enabled == 1;
+}
+
+uint64_t ProgramCache::makeKey(const GLchar *vertexSource,
+                               const GLchar *fragmentSource,
+                               const GLchar *geometrySource){
+    uint64_t key = 14695981039346656037ull;
+    key = hashString(reinterpret_cast<const char*>(glGetString(GL_VENDOR)), key);
+    key = hashString(reinterpret_cast<const char*>(glGetString(GL_RENDERER)), key);
+    key = hashString(reinterpret_cast<const char*>(glGetString(GL_VERSION)), key);
+    key = hashString(vertexSource, key);
+    key = hashString(fragmentSource, key);
+    key = hashString(geometrySource, key);
+    return key;
+}
+
+bool ProgramCache::load(GLuint program, uint64_t key){
+    if (!isEnabled())
+        return false;
+    std::ifstream file(pathFor(key), std::ios::binary);
+    if (!file){
+        ++_misses;
+        return false;
+    }
+    std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ProgramBinaryHeader header;
+    bool valid = contents.size() > sizeof(header);
+    if (valid){
+        std::memcpy(&header, contents.data(), sizeof(header));
+        valid = std::memcmp(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 && header.Key == key;
+    }
+    GLint linked = GL_FALSE;
+    if (valid){
+        glProgramBinary(program, header.Format, contents.data() + sizeof(header),
+                        static_cast<GLsizei>(contents.size() - sizeof(header)));
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    }
+    if (!linked){
+        // Invalidated (e.g. by a driver update): drop it, the caller compiles from source
+        std::remove(pathFor(key).c_str());
+        ++_misses;
+        return false;
+    }
+    ++_hits;
+    return true;
+}
+
+void ProgramCache::store(GLuint program, uint64_t key){
+    if (!isEnabled())
+        return;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    mkdir(_directory.c_str(), 0755);
+    std::ofstream file(pathFor(key), std::ios::binary | std::ios::trunc);
+    if (!file)
+        return;
+    ProgramBinaryHeader header;
+    std::memcpy(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.Format = format;
+    header.Key = key;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), length);
+}
+
+std::string ProgramCache::pathFor(uint64_t key){
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return _directory + "/" + name;
+}
@@ -0,0 +1,46 @@
+//
+//  ProgramCache.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <GL/glew.h>
+
+// ProgramCache stores linked program binaries on disk (glGetProgramBinary)
+// so warm starts can skip GLSL compilation entirely (glProgramBinary).
+// Binaries are keyed by a hash of the shader sources and the driver's
+// vendor/renderer/version strings, so a driver update or a shader edit
+// simply misses the cache. A binary the driver rejects is discarded and
+// the program is compiled from source again.
+class ProgramCache{
+public:
+    // Directory the binaries are written to (created on first store)
+    static void setDirectory(const std::string& directory);
+    // Enables/disables the cache (it is also disabled if the driver exposes no binary formats)
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    // Hashes the sources together with the current driver strings
+    static uint64_t makeKey(const GLchar *vertexSource,
+                            const GLchar *fragmentSource,
+                            const GLchar *geometrySource);
+    // Tries to load a binary for key into program. Returns true if the program is linked and usable
+    static bool load(GLuint program, uint64_t key);
+    // Writes the binary of a successfully linked program
+    static void store(GLuint program, uint64_t key);
+    // Statistics, e.g. to compare cold and warm starts
+    static int hits()   { return _hits; }
+    static int misses() { return _misses; }
+private:
+    ProgramCache() { }
+    static std::string pathFor(uint64_t key);
+
+    static std::string _directory;
+    static int _enabled; // -1 = not yet queried from the driver
+    static int _hits, _misses;
+};
@@ -0,0 +1,20 @@
+//
+//  RenderStats.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "RenderStats.hpp"
+
+int RenderStats::_drawCalls = 0;
+int RenderStats::_textureBinds = 0;
+int RenderStats::_lastDrawCalls = 0;
+int RenderStats::_lastTextureBinds = 0;
+
+void RenderStats::endFrame(){
+    _lastDrawCalls = _drawCalls;
+    _lastTextureBinds = _textureBinds;
+    _drawCalls = 0;
+    _textureBinds = 0;
+}
@@ -0,0 +1,26 @@
+//
+//  RenderStats.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+// RenderStats counts the GL work submitted per frame (draw calls,
+// texture binds) so it can be shown in the debug overlay.
+// The renderers bump the counters; endFrame() publishes the totals.
+class RenderStats{
+public:
+    static void drawCall()    { ++_drawCalls; }
+    static void textureBind() { ++_textureBinds; }
+    // Publishes the current frame's counters and resets them
+    static void endFrame();
+    // Counters of the last completed frame
+    static int drawCalls()    { return _lastDrawCalls; }
+    static int textureBinds() { return _lastTextureBinds; }
+private:
+    RenderStats() { }
+    static int _drawCalls, _textureBinds;
+    static int _lastDrawCalls, _lastTextureBinds;
+};
@@ -0,0 +1,39 @@
+//
+//  RenderTargetPool.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "RenderTargetPool.hpp"
+
+#include <iostream>
+
+#include "Screen.hpp"
+
+int RenderTargetPool::acquire(GLuint width, GLuint height){
+    for (std::size_t i = 0; i < _targets.size(); ++i){
+        RenderTarget& target = _targets[i];
+        if (!target.InUse && target.Texture.Width == width && target.Texture.Height == height){
+            target.InUse = true;
+            return static_cast<int>(i);
+        }
+    }
+    _targets.emplace_back();
+    RenderTarget& target = _targets.back();
+    target.InUse = true;
+    target.FBO.generate();
+    // Clamp so filtering and offset taps don't wrap around to the opposite edge
+    target.Texture.setWrap(GL_CLAMP_TO_EDGE);
+    target.Texture.generate(width, height, NULL);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.FBO.get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.Texture.getID(), 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::RENDERTARGETPOOL: Failed to initialize " << width << "x" << height << " target" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, Screen::framebuffer());
+    return static_cast<int>(_targets.size() - 1);
+}
+
+void RenderTargetPool::release(int target){
+    _targets[target].InUse = false;
+}
@@ -0,0 +1,41 @@
+//
+//  RenderTargetPool.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "GLResource.hpp"
+#include "Texture.hpp"
+
+// RenderTargetPool hands out offscreen color targets (a framebuffer
+// with a texture attached) for intermediate post-processing passes.
+// Targets are only allocated when no free target of the requested
+// size exists, and are reused frame after frame, so a chain of passes
+// ping-pongs between a handful of targets instead of owning its own.
+class RenderTargetPool{
+public:
+    RenderTargetPool() { }
+    // Returns the index of a free width x height target, allocating it if needed
+    int acquire(GLuint width, GLuint height);
+    // Makes the target available to later acquire() calls
+    void release(int target);
+    // The target's framebuffer and color texture
+    GLuint framebuffer(int target) const { return _targets[target].FBO.get(); }
+    TextureView texture(int target) const { return _targets[target].Texture.view(); }
+    // Number of targets allocated so far
+    std::size_t size() const { return _targets.size(); }
+private:
+    struct RenderTarget {
+        GLFramebuffer FBO;
+        Texture2D     Texture;
+        bool          InUse = false;
+    };
+    std::vector<RenderTarget> _targets;
+};
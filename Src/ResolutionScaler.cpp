@@ -0,0 +1,55 @@
+//
+//  ResolutionScaler.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "ResolutionScaler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Weight of the newest frame in the smoothed frame time
+    const float SMOOTHING = 0.1f;
+    // Overrun tolerated before scaling down, e.g. timer jitter around the vsync interval
+    const float OVERRUN_TOLERANCE = 1.05f;
+    // Frames to wait after a change before judging the new scale
+    const int COOLDOWN_FRAMES = 10;
+    // Frames within budget (about two seconds at 60Hz) before trying a higher scale
+    const int FRAMES_BEFORE_UPSCALE = 120;
+    const float UPSCALE_STEP = 0.05f;
+}
+
+ResolutionScaler::ResolutionScaler(float targetMs, float minScale, float maxScale)
+    : _targetMs(targetMs), _minScale(std::min(minScale, maxScale)), _maxScale(maxScale), _scale(maxScale){ }
+
+float ResolutionScaler::update(float frameMs){
+    _smoothedMs = _smoothedMs == 0.0f ? frameMs : _smoothedMs + (frameMs - _smoothedMs) * SMOOTHING;
+    if (_cooldown > 0){
+        --_cooldown;
+        return _scale;
+    }
+    float scale = _scale;
+    if (_smoothedMs > _targetMs * OVERRUN_TOLERANCE){
+        scale = _scale * std::sqrt(_targetMs / _smoothedMs);
+        _framesWithinBudget = 0;
+    }
+    else if (_smoothedMs > _targetMs){
+        // Inside the tolerance band: hold the current scale
+        _framesWithinBudget = 0;
+    }
+    else if (++_framesWithinBudget >= FRAMES_BEFORE_UPSCALE){
+        scale = _scale + UPSCALE_STEP;
+        _framesWithinBudget = 0;
+    }
+    scale = std::min(std::max(scale, _minScale), _maxScale);
+    if (scale != _scale){
+        _scale = scale;
+        _cooldown = COOLDOWN_FRAMES;
+        // Forget the frames rendered at the old scale
+        _smoothedMs = 0.0f;
+    }
+    return _scale;
+}
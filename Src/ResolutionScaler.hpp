@@ -0,0 +1,32 @@
+//
+//  ResolutionScaler.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+// ResolutionScaler is the frame-time controller behind dynamic resolution.
+// It smooths the measured frame times and picks the scene's render scale:
+// on an overrun the scale drops at once, by the square root of the overrun
+// (GPU cost follows the pixel count, i.e. scale squared); after a stretch
+// of frames within budget it creeps back up in small steps. Each change is
+// followed by a cooldown so the smoothed time reflects the new scale.
+// Frame times include the vsync wait, so with vsync on the target should be
+// the refresh interval: any missed vblank shows up as an overrun.
+class ResolutionScaler{
+public:
+    ResolutionScaler(float targetMs, float minScale, float maxScale);
+    // Feeds one frame's time and returns the scale to render the next frame at
+    float update(float frameMs);
+    float scale() const { return _scale; }
+    float targetMs() const { return _targetMs; }
+private:
+    float _targetMs;
+    float _minScale, _maxScale;
+    float _scale;
+    float _smoothedMs = 0.0f;
+    int _cooldown = 0;
+    int _framesWithinBudget = 0;
+};
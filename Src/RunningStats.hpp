@@ -0,0 +1,37 @@
+//
+//  RunningStats.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Count, mean, standard deviation and range of a stream of samples,
+// updated in constant time and space (Welford's algorithm).
+class RunningStats{
+public:
+    void add(double sample){
+        ++_count;
+        double delta = sample - _mean;
+        _mean += delta / _count;
+        _m2 += delta * (sample - _mean);
+        _min = _count == 1 ? sample : std::min(_min, sample);
+        _max = _count == 1 ? sample : std::max(_max, sample);
+    }
+    uint64_t count() const { return _count; }
+    double mean() const { return _mean; }
+    double stddev() const { return _count > 1 ? std::sqrt(_m2 / (_count - 1)) : 0.0; }
+    double min() const { return _min; }
+    double max() const { return _max; }
+private:
+    uint64_t _count = 0;
+    double _mean = 0.0;
+    double _m2 = 0.0;
+    double _min = 0.0;
+    double _max = 0.0;
+};
@@ -0,0 +1,10 @@
+//
+//  Screen.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "Screen.hpp"
+
+GLuint Screen::_framebuffer = 0;
@@ -0,0 +1,23 @@
+//
+//  Screen.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <GL/glew.h>
+
+// Screen names the framebuffer a frame ends up in: the window's default
+// framebuffer (0) normally, or the offscreen framebuffer standing in for
+// it when running headless. Renderers bind Screen::framebuffer() where
+// they would otherwise bind 0.
+class Screen{
+public:
+    static GLuint framebuffer() { return _framebuffer; }
+    static void setFramebuffer(GLuint framebuffer) { _framebuffer = framebuffer; }
+private:
+    Screen() { }
+    static GLuint _framebuffer;
+};
@@ -18,6 +18,8 @@
 
 #include <iostream>
 
+#include "ProgramCache.hpp"
+
 Shader &Shader::use(){
     glUseProgram(ID);
     return *this;
@@ -26,6 +28,15 @@ Shader &Shader::use(){
 void Shader::compile(const GLchar* vertexSource,
                      const GLchar* fragmentSource,
                      const GLchar* geometrySource){
+    // Skip compilation altogether if a binary of this exact program is cached
+    uint64_t cacheKey = 0;
+    if (ProgramCache::isEnabled()){
+        cacheKey = ProgramCache::makeKey(vertexSource, fragmentSource, geometrySource);
+        ID = glCreateProgram();
+        if (ProgramCache::load(ID, cacheKey))
+            return;
+        glDeleteProgram(ID);
+    }
     GLuint sVertex, sFragment, gShader = 0;
     // Vertex Shader
     sVertex = glCreateShader(GL_VERTEX_SHADER);
@@ -50,8 +61,14 @@ void Shader::compile(const GLchar* vertexSource,
     glAttachShader(ID, sFragment);
     if (geometrySource != nullptr)
         glAttachShader(ID, gShader);
+    if (ProgramCache::isEnabled())
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(ID);
     checkCompileErrors(ID, "PROGRAM");
+    GLint linked = GL_FALSE;
+    glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+    if (linked && ProgramCache::isEnabled())
+        ProgramCache::store(ID, cacheKey);
     // Delete the shaders as they're linked into our program now and no longer necessery
     glDeleteShader(sVertex);
     glDeleteShader(sFragment);
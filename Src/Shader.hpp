@@ -27,15 +27,17 @@
 // General purpsoe shader object. Compiles from file, generates
 // compile/link-time error messages and hosts several utility
 // functions for easy management.
+// Shader is a lightweight handle that may be freely copied; the
+// program object itself is owned by the ResourceManager.
 class Shader{
 public:
     // State
-    GLuint ID;
+    GLuint ID = 0;
     // Constructor
     Shader() { }
     // Sets the current shader as active
     Shader  &use();
-    // Compiles the shader from given source code
+    // Compiles the shader from given source code (or loads it from the ProgramCache)
     void    compile(const GLchar *vertexSource,
                     const GLchar *fragmentSource,
                     const GLchar *geometrySource = nullptr); // Note: geometry source code is optional
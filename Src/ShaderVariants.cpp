@@ -0,0 +1,46 @@
+//
+//  ShaderVariants.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#include "ShaderVariants.hpp"
+
+#include "ResourceManager.hpp"
+#include "Profiler.hpp"
+
+ShaderVariants::ShaderVariants(const GLchar *vShaderFile, const GLchar *fShaderFile,
+                               std::vector<std::string> bitDefines)
+    : _vertexSource(ResourceManager::loadText(vShaderFile)),
+      _fragmentSource(ResourceManager::loadText(fShaderFile)),
+      _bitDefines(std::move(bitDefines)){ }
+
+Shader ShaderVariants::get(uint32_t key, bool* isNew){
+    auto it = _variants.find(key);
+    if (isNew)
+        *isNew = it == _variants.end();
+    if (it != _variants.end())
+        return it->second.Program;
+    PROFILE_SCOPE("ShaderVariants::compile");
+    std::string defines = _commonDefines;
+    for (std::size_t bit = 0; bit < _bitDefines.size(); ++bit)
+        if (key & (1u << bit))
+            defines += "#define " + _bitDefines[bit] + "\n";
+    std::string vertexCode = inject(_vertexSource, defines);
+    std::string fragmentCode = inject(_fragmentSource, defines);
+    Variant& variant = _variants[key];
+    variant.Program.compile(vertexCode.c_str(), fragmentCode.c_str());
+    variant.Owner = GLProgram(variant.Program.ID);
+    return variant.Program;
+}
+
+std::string ShaderVariants::inject(const std::string& source, const std::string& defines){
+    // #version has to stay the first directive, so the defines go on the lines after it
+    std::size_t version = source.find("#version");
+    std::size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+    if (lineEnd == std::string::npos)
+        return defines + source;
+    // #line keeps compile errors pointing at the lines of the original file
+    return source.substr(0, lineEnd + 1) + defines + "#line 2\n" + source.substr(lineEnd + 1);
+}
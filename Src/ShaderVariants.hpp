@@ -0,0 +1,48 @@
+//
+//  ShaderVariants.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "GLResource.hpp"
+#include "Shader.hpp"
+
+// ShaderVariants compiles specialised programs from one pair of shader
+// sources. A variant is identified by a bit mask: every set bit adds the
+// matching #define (plus any defines shared by all variants) right after
+// the #version line. Variants are compiled lazily, the first time their
+// key is requested, and owned until the object is destroyed; compiling
+// goes through Shader::compile, so the ProgramCache covers them too.
+class ShaderVariants{
+public:
+    ShaderVariants(const GLchar *vShaderFile, const GLchar *fShaderFile,
+                   std::vector<std::string> bitDefines);
+    // Defines added to every variant compiled from now on (e.g. baked-in constants)
+    void setCommonDefines(const std::string& defines) { _commonDefines = defines; }
+    // Returns the program for key, compiling it on first use. isNew is set when it was
+    // just compiled, so one-off uniforms can be set
+    Shader get(uint32_t key, bool* isNew = nullptr);
+    // Number of variants compiled so far
+    std::size_t size() const { return _variants.size(); }
+private:
+    struct Variant {
+        Shader    Program;
+        GLProgram Owner;
+    };
+    // Inserts defines after the #version directive of source
+    static std::string inject(const std::string& source, const std::string& defines);
+    std::string _vertexSource, _fragmentSource;
+    std::vector<std::string> _bitDefines;
+    std::string _commonDefines;
+    std::map<uint32_t, Variant> _variants;
+};
@@ -15,17 +15,14 @@
  ** option) any later version.
  ******************************************************************/
 #include "SpriteRenderer.hpp"
+#include "RenderStats.hpp"
 
 SpriteRenderer::SpriteRenderer(Shader&& shader){
     _shader = shader;
     initRenderData();
 }
 
-SpriteRenderer::~SpriteRenderer(){
-    glDeleteVertexArrays(1, &_quadVAO);
-}
-
-void SpriteRenderer::drawSprite(Texture2D&& texture,
+void SpriteRenderer::drawSprite(TextureView texture,
                                 glm::vec2 position,
                                 glm::vec2 size,
                                 float rotate,
@@ -55,14 +52,14 @@ void SpriteRenderer::drawSprite(Texture2D&& texture,
     glActiveTexture(GL_TEXTURE0);
     texture.bind();
     
-    glBindVertexArray(_quadVAO);
+    glBindVertexArray(_quadVAO.get());
+    RenderStats::drawCall();
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
 }
 
 void SpriteRenderer::initRenderData(){
     // Configure VAO/VBO
-    GLuint VBO;
     float vertices[] = {
         // Pos      // Tex
         0.0f, 1.0f, 0.0f, 1.0f,
@@ -74,13 +71,13 @@ void SpriteRenderer::initRenderData(){
         1.0f, 0.0f, 1.0f, 0.0f
     };
     
-    glGenVertexArrays(1, &_quadVAO);
-    glGenBuffers(1, &VBO);
+    _quadVAO.generate();
+    _quadVBO.generate();
     
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, _quadVBO.get());
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     
-    glBindVertexArray(_quadVAO);
+    glBindVertexArray(_quadVAO.get());
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (GLvoid*)0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
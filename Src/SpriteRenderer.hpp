@@ -23,26 +23,39 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "GLResource.hpp"
 #include "Texture.hpp"
 #include "Shader.hpp"
 
+// Everything needed to draw one sprite, detached from the object it came from
+struct SpriteInstance {
+    TextureView Sprite;
+    glm::vec2   Position = glm::vec2(0.0f);
+    glm::vec2   Size = glm::vec2(10.0f);
+    float       Rotation = 0.0f;
+    glm::vec3   Color = glm::vec3(1.0f);
+};
 
 class SpriteRenderer{
 public:
     // Constructor (inits shaders/shapes)
     SpriteRenderer(Shader& shader) = delete;
     SpriteRenderer(Shader&& shader);
-    // Destructor
-    ~SpriteRenderer();
+    // Destructor (the quad's VAO/VBO are released by their owning handles)
+    ~SpriteRenderer() = default;
     // Renders a defined quad textured with given sprite
-    void drawSprite(Texture2D&& texture, glm::vec2 position,
+    void drawSprite(TextureView texture, glm::vec2 position,
                     glm::vec2 size = glm::vec2(10, 10),
                     float rotate = 0.0f,
                     glm::vec3 color = glm::vec3(1.0f));
+    void drawSprite(const SpriteInstance& sprite){
+        drawSprite(sprite.Sprite, sprite.Position, sprite.Size, sprite.Rotation, sprite.Color);
+    }
 private:
     // Render state
     Shader _shader;
-    GLuint _quadVAO;
+    GLVertexArray _quadVAO;
+    GLBuffer      _quadVBO;
     // Initializes and configures the quad's buffer and vertex attributes
     void initRenderData();
 };
@@ -0,0 +1,51 @@
+//
+//  SpscQueue.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// SpscQueue is a fixed-size, lock-free FIFO between exactly one producer
+// thread and one consumer thread. Neither side ever blocks: push() fails
+// when the queue is full, peek() returns nullptr when it is empty.
+// Capacity must be a power of two.
+template <typename T, std::size_t Capacity>
+class SpscQueue{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+public:
+    SpscQueue() { }
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer: appends value; false if the queue is full
+    bool push(const T& value){
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        _items[tail & MASK] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    // Consumer: the oldest value, or nullptr if the queue is empty
+    const T* peek() const{
+        std::size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return nullptr;
+        return &_items[head & MASK];
+    }
+    // Consumer: removes the value returned by peek()
+    void pop(){
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+private:
+    static const std::size_t MASK = Capacity - 1;
+    T _items[Capacity];
+    // Indices only grow; each is written by one side and read by the other
+    alignas(64) std::atomic<std::size_t> _head{0};
+    alignas(64) std::atomic<std::size_t> _tail{0};
+};
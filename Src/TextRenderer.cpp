@@ -14,6 +14,7 @@
 #include FT_FREETYPE_H
 
 #include "TextRenderer.hpp"
+#include "RenderStats.hpp"
 #include "ResourceManager.hpp"
 
 
@@ -26,10 +27,10 @@ TextRenderer::TextRenderer(GLuint width, GLuint height){
     _textShader.setMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), GL_TRUE);
     _textShader.setInteger("text", 0);
     // Configure VAO/VBO for texture quads
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    VAO.generate();
+    VBO.generate();
+    glBindVertexArray(VAO.get());
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
     glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
@@ -38,15 +39,19 @@ TextRenderer::TextRenderer(GLuint width, GLuint height){
 }
 
 void TextRenderer::load(std::string font, GLuint fontSize){
-    // First clear the previously loaded Characters
+    // First clear the previously loaded Characters (and delete their textures)
     _characters.clear();
+    _glyphTextures.clear();
     // Then initialize and load the FreeType library
     FT_Library ft;
     if (FT_Init_FreeType(&ft)) // All functions return a value different than 0 whenever an error occurred
         std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
     // Load font as face
     FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
+    AssetView asset = ResourceManager::findAsset(font);
+    FT_Error error = asset ? FT_New_Memory_Face(ft, asset.Data, static_cast<FT_Long>(asset.Size), 0, &face)
+                           : FT_New_Face(ft, font.c_str(), 0, &face);
+    if (error)
         std::cout << "ERROR::FREETYPE: Failed to load font: " << font.c_str() << std::endl;
     // Set size to load glyphs as
     FT_Set_Pixel_Sizes(face, 0, fontSize);
@@ -60,8 +65,10 @@ void TextRenderer::load(std::string font, GLuint fontSize){
             continue;
         }
         // Generate texture
-        GLuint texture;
-        glGenTextures(1, &texture);
+        GLTexture glyphTexture;
+        glyphTexture.generate();
+        GLuint texture = glyphTexture.get();
+        _glyphTextures.push_back(std::move(glyphTexture));
         glBindTexture(GL_TEXTURE_2D, texture);
         glTexImage2D(
             GL_TEXTURE_2D,
@@ -100,18 +107,14 @@ void TextRenderer::renderText(std::string text, float x, float y, float scale, g
     _textShader.use();
     _textShader.setVector3f("textColor", color);
     glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
+    glBindVertexArray(VAO.get());
 
-    // Iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++){
-        Character ch = _characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y + (_characters['H'].Bearing.y - ch.Bearing.y) * scale;//calculate the vertical offset as the distance a glyph is pushed downwards from the top of the glyph space
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
+    layoutText(text, x, y, scale, _quads);
+    for (const GlyphQuad& quad : _quads){
+        float xpos = quad.X;
+        float ypos = quad.Y;
+        float w = quad.Width;
+        float h = quad.Height;
         // Update VBO for each character
         float vertices[6][4] = {
             { xpos,     ypos + h,   0.0, 1.0 },
@@ -123,17 +126,41 @@ void TextRenderer::renderText(std::string text, float x, float y, float scale, g
             { xpos + w, ypos,       1.0, 0.0 }
         };
         // Render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+        RenderStats::textureBind();
+        glBindTexture(GL_TEXTURE_2D, quad.TextureID);
         // Update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
         glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // Be sure to use glBufferSubData and not glBufferData
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         // Render quad
+        RenderStats::drawCall();
         glDrawArrays(GL_TRIANGLES, 0, 6);
-        // Now advance cursors for next glyph
-        x += (ch.Advance >> 6) * scale; // Bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
     }
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
+
+void TextRenderer::layoutText(const std::string& text, float x, float y, float scale, std::vector<GlyphQuad>& quads) const{
+    quads.clear();
+    // Characters that were not loaded take no space
+    const Character none = {};
+    auto find = [&](GLchar c) -> const Character& {
+        auto it = _characters.find(c);
+        return it != _characters.end() ? it->second : none;
+    };
+    // Glyphs hang from the top of an 'H'
+    int top = find('H').Bearing.y;
+    for (GLchar c : text){
+        const Character& ch = find(c);
+        GlyphQuad quad;
+        quad.TextureID = ch.TextureID;
+        quad.X = x + ch.Bearing.x * scale;
+        quad.Y = y + (top - ch.Bearing.y) * scale;//calculate the vertical offset as the distance a glyph is pushed downwards from the top of the glyph space
+        quad.Width = ch.Size.x * scale;
+        quad.Height = ch.Size.y * scale;
+        quads.push_back(quad);
+        // Now advance cursors for next glyph
+        x += (ch.Advance >> 6) * scale; // Bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
+    }
+}
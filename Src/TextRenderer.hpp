@@ -9,21 +9,30 @@
 #pragma once
 
 #include <map>
+#include <vector>
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include "GLResource.hpp"
 #include "Texture.hpp"
 #include "Shader.hpp"
 
 /// Holds all state information relevant to a character as loaded using FreeType
 struct Character {
-    GLuint TextureID;   // ID handle of the glyph texture
+    GLuint TextureID;   // ID handle of the glyph texture (owned by the TextRenderer)
     glm::ivec2 Size;    // Size of glyph
     glm::ivec2 Bearing; // Offset from baseline to left/top of glyph
     GLuint Advance;     // Horizontal offset to advance to next glyph
 };
 
+/// Where one character of a laid out string is drawn
+struct GlyphQuad {
+    GLuint TextureID;
+    float X, Y;          // Top left
+    float Width, Height;
+};
+
 // A renderer class for rendering text displayed by a font loaded using the
 // FreeType library. A single font is loaded, processed into a list of Character
 // items for later rendering.
@@ -34,12 +43,19 @@ public:
     void load(std::string font, GLuint fontSize);
     // Renders a string of text using the precompiled list of characters
     void renderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // Lays text out at (x, y) without drawing it: one quad per character, in order
+    void layoutText(const std::string& text, float x, float y, float scale, std::vector<GlyphQuad>& quads) const;
 
 private:
     // Render state
-    GLuint VAO, VBO;
+    GLVertexArray VAO;
+    GLBuffer VBO;
+    // Owns the glyph textures referenced by _characters
+    std::vector<GLTexture> _glyphTextures;
     // Shader used for text rendering
     Shader _textShader;
     // Holds a list of pre-compiled Characters
     std::map<GLchar, Character> _characters;
+    // Layout of the string being rendered (kept to reuse its memory)
+    std::vector<GlyphQuad> _quads;
 };
@@ -17,6 +17,7 @@
 #include <iostream>
 
 #include "Texture.hpp"
+#include "RenderStats.hpp"
 
 
 Texture2D::Texture2D()
@@ -28,15 +29,14 @@ Texture2D::Texture2D()
                     Wrap_S(GL_REPEAT),
                     Wrap_T(GL_REPEAT),
                     Filter_Min(GL_LINEAR),
-                    Filter_Max(GL_LINEAR){
-    glGenTextures(1, &ID);
-}
+                    Filter_Max(GL_LINEAR){ }
 
 void Texture2D::generate(GLuint width, GLuint height, unsigned char* data){
     Width = width;
     Height = height;
-    // Create Texture
-    glBindTexture(GL_TEXTURE_2D, ID);
+    // Create Texture (the name is only generated once, re-generating reuses it)
+    _texture.generate();
+    glBindTexture(GL_TEXTURE_2D, _texture.get());
     glTexImage2D(GL_TEXTURE_2D, 0, Internal_Format, width, height, 0, Image_Format, GL_UNSIGNED_BYTE, data);
     // Set Texture wrap and filter modes
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, Wrap_S);
@@ -49,5 +49,12 @@ void Texture2D::generate(GLuint width, GLuint height, unsigned char* data){
 
 void Texture2D::bind() const
 {
+    RenderStats::textureBind();
+    glBindTexture(GL_TEXTURE_2D, _texture.get());
+}
+
+void TextureView::bind() const
+{
+    RenderStats::textureBind();
     glBindTexture(GL_TEXTURE_2D, ID);
 }
@@ -18,31 +18,56 @@
 
 #include <GL/glew.h>
 
+#include "GLResource.hpp"
+
+// TextureView is a cheap, non-owning reference to a texture owned
+// elsewhere (usually by the ResourceManager). Sprites and renderers
+// hold views so that copying game objects never touches GL state.
+class TextureView{
+public:
+    TextureView() : ID(0), Width(0), Height(0) { }
+    TextureView(GLuint id, GLuint width, GLuint height) : ID(id), Width(width), Height(height) { }
+    // Binds the texture as the current active GL_TEXTURE_2D texture object
+    void bind() const;
+
+    GLuint ID;
+    GLuint Width, Height;
+};
+
 // Texture2D is able to store and configure a texture in OpenGL.
 // It also hosts utility functions for easy management.
+// Texture2D owns its GL texture: it is move-only and the texture name
+// is only created on generate(), and deleted when the Texture2D dies.
 class Texture2D{
 public:
+    // Constructor (sets default texture modes)
     Texture2D();
+    Texture2D(Texture2D&&) = default;
+    Texture2D& operator=(Texture2D&&) = default;
     // Generates texture from image data
     void generate(GLuint width, GLuint height, unsigned char* data);
+    // Sets the wrapping mode on both axes (applied by the next generate)
+    void setWrap(GLuint wrap) { Wrap_S = wrap; Wrap_T = wrap; }
     // Binds the texture as the current active GL_TEXTURE_2D texture object
     void bind() const;
-    
-    //TODO: move to private
+    // Returns a non-owning view of this texture
+    TextureView view() const { return TextureView(_texture.get(), Width, Height); }
     // Holds the ID of the texture object, used for all texture operations to reference to this particlar texture
-    GLuint ID;
+    GLuint getID() const { return _texture.get(); }
+    
     // Texture image dimensions
     GLuint Width, Height; // Width and height of loaded image in pixels
     // Texture Format
     GLuint Internal_Format; // Format of texture object
     GLuint Image_Format; // Format of loaded image
 private:
+    // Owned texture object
+    GLTexture _texture;
     // Texture configuration
     GLuint Wrap_S; // Wrapping mode on S axis
     GLuint Wrap_T; // Wrapping mode on T axis
     GLuint Filter_Min; // Filtering mode if texture pixels < screen pixels
     GLuint Filter_Max; // Filtering mode if texture pixels > screen pixels
-    // Constructor (sets default texture modes)
 };
 
 #endif
@@ -0,0 +1,52 @@
+//
+//  TripleBuffer.hpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// TripleBuffer hands values from one producer thread to one consumer
+// thread without locks and without either side ever waiting. The producer
+// fills back() and publishes it; the consumer picks up the newest
+// published value with update() and reads it through front(). Values the
+// consumer was too slow to pick up are overwritten, so it always sees the
+// latest one. Slots are reused, so T's buffers keep their capacity.
+template <typename T>
+class TripleBuffer{
+public:
+    TripleBuffer() : _middle(1) { }
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer: the slot being filled
+    T& back() { return _slots[_back]; }
+    // Producer: makes back() the newest value and takes a free slot to fill next
+    void publish(){
+        uint8_t previous = _middle.exchange(static_cast<uint8_t>(_back | NEW_VALUE), std::memory_order_acq_rel);
+        _back = previous & SLOT_MASK;
+    }
+    // Consumer: switches front() to the newest published value; false if nothing was published since
+    bool update(){
+        if (!(_middle.load(std::memory_order_relaxed) & NEW_VALUE))
+            return false;
+        uint8_t previous = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = previous & SLOT_MASK;
+        return true;
+    }
+    // Consumer: the value picked up by the last update()
+    const T& front() const { return _slots[_front]; }
+private:
+    static const uint8_t SLOT_MASK = 3;
+    static const uint8_t NEW_VALUE = 4;
+    T _slots[3];
+    // Slot between the two threads, with NEW_VALUE set while the consumer hasn't taken it
+    alignas(64) std::atomic<uint8_t> _middle;
+    // Each index is only touched by its own thread
+    alignas(64) uint8_t _back = 0;
+    alignas(64) uint8_t _front = 2;
+};
@@ -13,6 +13,13 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include "WindowManager.hpp"
+#include "Screen.hpp"
+#include "Clock.hpp"
+
+#if BREAKOUT_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 // Error callback for GLFW error handling
 void error_callback(int error, const char* description){
@@ -20,7 +27,13 @@ void error_callback(int error, const char* description){
 }
 
 WindowManager::WindowManager(){
-    //GLFW init logic
+    glfwSetErrorCallback(error_callback);
+}
+
+void WindowManager::createWindow(int width, int height, const char* title, GLFWmonitor* monitor, GLFWwindow* share){
+    _width = width;
+    _height = height;
+    //GLFW init logic (only in windowed mode, it needs a display)
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -28,37 +41,164 @@ WindowManager::WindowManager(){
     glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GL_FALSE);
-    glfwSetErrorCallback(error_callback);
-}
-
-void WindowManager::createWindow(int width, int height, const char* title, GLFWmonitor* monitor, GLFWwindow* share){
-    _width = width;
-    _height = height;
     //OpenGL configureview port
     _window = glfwCreateWindow(width, height, title , nullptr, nullptr);
     glfwMakeContextCurrent(_window);
+    glfwSetWindowUserPointer(_window, this);
+    glfwSetWindowRefreshCallback(_window, [](GLFWwindow* window){
+        static_cast<WindowManager*>(glfwGetWindowUserPointer(window))->_refreshRequested = true;
+    });
     
     glewExperimental = GL_TRUE;
     glewInit();
     glGetError(); // Call it once to catch glewInit() bug, all other errors are now from our application.
 }
 
+bool WindowManager::createHeadless(int width, int height){
+#if BREAKOUT_HEADLESS
+    _width = width;
+    _height = height;
+    // Surfaceless platform first (no display server at all), then whatever the default display is
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)){
+        std::cout << "ERROR::WINDOWMANAGER: Failed to initialize EGL" << std::endl;
+        return false;
+    }
+    // The surface type defaults to windows, which a surfaceless display has none of
+    const EGLint configAttributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config;
+    EGLint configCount = 0;
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = EGL_NO_CONTEXT;
+    if (eglChooseConfig(display, configAttributes, &config, 1, &configCount) && configCount > 0 && eglBindAPI(EGL_OPENGL_API))
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    // Without a surface, the context renders only into framebuffer objects
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)){
+        std::cout << "ERROR::WINDOWMANAGER: Failed to create a surfaceless OpenGL 3.3 context" << std::endl;
+        if (context != EGL_NO_CONTEXT)
+            eglDestroyContext(display, context);
+        eglTerminate(display);
+        return false;
+    }
+    _eglDisplay = display;
+    _eglContext = context;
+    _headless = true;
+    
+    // glewInit() looks for GLX, which doesn't exist here; glewContextInit only needs the current context
+    glewExperimental = GL_TRUE;
+    glewContextInit();
+    glGetError();
+    std::cout << "Headless rendering on " << glGetString(GL_RENDERER) << " (EGL " << major << "." << minor << ")" << std::endl;
+    
+    // The offscreen framebuffer takes the place of the window's default framebuffer
+    _offscreenFBO.generate();
+    _offscreenColor.generate();
+    glBindRenderbuffer(GL_RENDERBUFFER, _offscreenColor.get());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, _offscreenFBO.get());
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _offscreenColor.get());
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::WINDOWMANAGER: Failed to initialize the offscreen framebuffer" << std::endl;
+    Screen::setFramebuffer(_offscreenFBO.get());
+    return true;
+#else
+    std::cout << "ERROR::WINDOWMANAGER: Built without headless support (BREAKOUT_HEADLESS=0)" << std::endl;
+    return false;
+#endif
+}
+
 void WindowManager::configureOpenGL(){
-    int width, height;
-    glfwGetFramebufferSize(_window, &width, &height);
-    glViewport(0, 0, width/2, height/2);
+    int width = _width, height = _height;
+    if (_window)
+        glfwGetFramebufferSize(_window, &width, &height);
+    // The offscreen framebuffer is exactly width x height
+    if (_headless)
+        glViewport(0, 0, width, height);
+    else
+        glViewport(0, 0, width/2, height/2);
     glEnable(GL_CULL_FACE);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 void WindowManager::pollEvents(){
-    glfwPollEvents();
+    if (!_headless)
+        glfwPollEvents();
+}
+
+bool WindowManager::waitEvents(double timeout){
+    if (_headless)
+        return false;
+    uint64_t start = Clock::now();
+    glfwWaitEventsTimeout(timeout);
+    return Clock::now() - start < Clock::fromSeconds(timeout);
+}
+
+bool WindowManager::takeRefreshRequest(){
+    bool requested = _refreshRequested;
+    _refreshRequested = false;
+    return requested;
 }
 
 bool WindowManager::windowShouldClose(){
-    return glfwWindowShouldClose(_window);
+    // Headless runs are bounded by the caller (a frame count)
+    return _headless ? false : glfwWindowShouldClose(_window);
+}
+
+void WindowManager::swapBuffers(){
+    if (_headless)
+        ++_headlessFrames;
+    else
+        glfwSwapBuffers(_window);
+}
+
+void WindowManager::skipFrame(){
+    if (_headless)
+        ++_headlessFrames;
+}
+
+uint64_t WindowManager::getTime() const{
+    return _headless ? static_cast<uint64_t>(_headlessFrames) * 1000000000 / 60 : Clock::now();
+}
+
+void WindowManager::setSwapInterval(int interval){
+    if (!_headless)
+        glfwSwapInterval(interval);
+}
+
+bool WindowManager::supportsAdaptiveSync() const{
+    if (_headless)
+        return false;
+    return glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+}
+
+int WindowManager::refreshRate() const{
+    if (_headless)
+        return 60;
+    const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    return mode && mode->refreshRate > 0 ? mode->refreshRate : 60;
 }
 
 void WindowManager::closeWindow(){
-    
+    Screen::setFramebuffer(0);
+    _offscreenColor.reset();
+    _offscreenFBO.reset();
+#if BREAKOUT_HEADLESS
+    if (_eglDisplay){
+        eglMakeCurrent(_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(_eglDisplay, _eglContext);
+        eglTerminate(_eglDisplay);
+        _eglDisplay = _eglContext = nullptr;
+    }
+#endif
 }
@@ -14,19 +14,68 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include "GLResource.hpp"
+
+// Set BREAKOUT_HEADLESS to 0 to build without the EGL headless backend (it needs libEGL)
+#ifndef BREAKOUT_HEADLESS
+#if defined(__linux__)
+#define BREAKOUT_HEADLESS 1
+#else
+#define BREAKOUT_HEADLESS 0
+#endif
+#endif
+
+// WindowManager owns the OpenGL context and what frames are presented to:
+// a GLFW window, or, when running headless (no display, possibly no GPU),
+// a surfaceless EGL context rendering into an offscreen framebuffer. Mesa
+// provides EGL on top of the GPU drivers and of its software rasterisers
+// (llvmpipe/softpipe, e.g. with LIBGL_ALWAYS_SOFTWARE=1), so the same
+// binary renders on CI boxes. Headless frames advance a fixed 60Hz clock.
 class WindowManager{//TODO: add constructor with with and heightr
 public:
     WindowManager();
     void createWindow(int width, int height, const char* title, GLFWmonitor* monitor, GLFWwindow* share);
+    // Creates a headless context and a width x height offscreen framebuffer; false if unavailable
+    bool createHeadless(int width, int height);
     void configureOpenGL();
     bool windowShouldClose();
     void pollEvents();
+    // Low-power alternative to pollEvents: sleeps until an event arrives or timeout seconds pass.
+    // Returns whether it was woken by an event (always false headless, where it does not wait)
+    bool waitEvents(double timeout);
+    // Whether the window contents were damaged (e.g. uncovered) since the last call and need redrawing
+    bool takeRefreshRequest();
+    // Presents the frame (a no-op when headless, apart from advancing the clock)
+    void swapBuffers();
+    // Ends a frame that was not redrawn: the last frame stays on screen, the headless clock still advances
+    void skipFrame();
+    // Frame clock in ns: Clock::now(), or frames * 1/60s when headless
+    uint64_t getTime() const;
+    // Refreshes to wait for per swap: 0 presents immediately, 1 is vsync, -1 is adaptive vsync
+    // (vsync that tears instead of waiting a whole refresh when a frame is late). No-op when headless
+    void setSwapInterval(int interval);
+    // Whether the driver accepts a swap interval of -1
+    bool supportsAdaptiveSync() const;
+    // Refresh rate of the primary monitor in Hz (60 when headless or unknown)
+    int refreshRate() const;
+    // Releases the offscreen framebuffer and the context
     void closeWindow();
     
     GLFWwindow& getWindow(){return *_window;}
+    bool isHeadless() const { return _headless; }
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
     
 private:
     GLFWwindow* _window = nullptr;
+    bool _refreshRequested = false;
     int _width;
     int _height;
+    // Headless state
+    bool _headless = false;
+    void* _eglDisplay = nullptr;
+    void* _eglContext = nullptr;
+    GLFramebuffer  _offscreenFBO;
+    GLRenderbuffer _offscreenColor;
+    long long _headlessFrames = 0;
 };
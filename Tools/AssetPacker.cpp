@@ -0,0 +1,30 @@
+//
+//  AssetPacker.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+// Command line tool that bundles loose asset files into a single pack
+// for AssetPack/ResourceManager::mountAssetPack.
+// Assets are indexed by the path given on the command line, so run it from
+// the directory the game runs from, e.g.:
+//   AssetPacker Resources/assets.pack Resources/shaders/* Resources/levels/* ...
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AssetPack.hpp"
+
+int main(int argc, char *argv[]){
+    if (argc < 3){
+        std::cout << "Usage: " << argv[0] << " <output.pack> <asset file>..." << std::endl;
+        return 1;
+    }
+    std::vector<std::string> files(argv + 2, argv + argc);
+    if (!AssetPack::write(argv[1], files))
+        return 1;
+    std::cout << "Packed " << files.size() << " assets into " << argv[1] << std::endl;
+    return 0;
+}
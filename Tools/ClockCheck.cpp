@@ -0,0 +1,220 @@
+//
+//  ClockCheck.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+// Command line check that the game's timing holds up over weeks of uptime.
+// No real waiting: it steps simulated Clock timestamps (uint64 ns) at 60Hz
+// and checks
+//  - on each of days 1 to 60 after the clock's epoch, that the frame time,
+//    Clock::toSeconds(now - last), stays at 16.667ms, and the post-processing
+//    time, Clock::phase(now, EFFECT_PERIOD_NS), within PHASE_TOLERANCE of the
+//    exact position in the period;
+//  - the game time as the game keeps it, Game::update adding
+//    Clock::fromSeconds(dt) every frame, over all 60 days of frames: dt as the
+//    main loop computes it (a float from the frame timestamps) and as the
+//    simulation thread passes it (a fixed 1/60 float). Every frame must move
+//    the animations by dt, and the total may drift from the real elapsed time
+//    by no more than the rounding of dt allows;
+// and that the float seconds the game used to keep have broken down by then
+// (which shows the check catches that bug). Needs nothing but Clock.
+// Exits with 1 on any failure:
+//   ClockCheck [--verbose]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "Clock.hpp"
+
+namespace {
+    const uint64_t DAY_NS = 86400ull * 1000000000ull;
+    const int FIRST_DAY = 1;
+    const int LAST_DAY = 60;
+    // Frames simulated from the start of every day
+    const int FRAMES = 600;
+    // 60Hz frames land on whole ns: frame k is at k * 1e9 / 60, rounded down
+    uint64_t frameTime(uint64_t start, uint64_t frame) { return start + frame * 1000000000ull / 60; }
+    const uint64_t FRAMES_PER_DAY = 86400ull * 60;
+
+    const double FRAME_SECONDS = 1.0 / 60.0;
+    // Rounding frames to whole ns moves a frame time by at most 1ns
+    const double DT_TOLERANCE = 1.5e-9;
+    // A float below 2*pi is exact to 2.4e-7 s; the animations multiply time by up to 15
+    const double PHASE_TOLERANCE = 1e-6;
+    // Each frame added to the game time: dt goes through a float (exact to 1.9e-9 s around 1/60) and is
+    // rounded to whole ns
+    const double STEP_TOLERANCE = 2.5e-9;
+    // The float path counts as broken once a frame time is off by this much
+    const double FLOAT_BROKEN = 1e-3;
+
+    double periodSeconds() { return Clock::EFFECT_PERIOD_NS / 1e9; }
+
+    // Distance between two positions in the period, either way round
+    double phaseError(double phase, double exact){
+        double error = std::abs(phase - exact);
+        return std::min(error, periodSeconds() - error);
+    }
+
+    // How far the animations move from one phase to the next, wrapping around the period
+    double phaseStep(double from, double to){
+        return to >= from ? to - from : to + periodSeconds() - from;
+    }
+
+    struct DayResult {
+        double MaxDtError = 0.0;      // s, Clock::toSeconds
+        double MaxPhaseError = 0.0;   // s, Clock::phase
+        double MinFloatDt = 1.0;      // s, float seconds since start
+        double MaxFloatDt = 0.0;
+        double MaxFloatPhaseError = 0.0; // s, float seconds wrapped in float
+    };
+
+    DayResult checkDay(int day){
+        DayResult result;
+        uint64_t start = day * DAY_NS;
+        uint64_t last = frameTime(start, 0);
+        float lastSeconds = static_cast<float>(Clock::toSeconds(last));
+        for (int frame = 1; frame <= FRAMES; ++frame){
+            uint64_t now = frameTime(start, frame);
+            // Exact position in the period: the wrap is exact on integers, and a double holds the rest exactly
+            double exactPhase = (now % Clock::EFFECT_PERIOD_NS) / 1e9;
+            double dt = Clock::toSeconds(now - last);
+            double phase = Clock::phase(now, Clock::EFFECT_PERIOD_NS);
+            result.MaxDtError = std::max(result.MaxDtError, std::abs(dt - FRAME_SECONDS));
+            result.MaxPhaseError = std::max(result.MaxPhaseError, phaseError(phase, exactPhase));
+            // What the game did before Clock: seconds since start in a float, dt as a float difference,
+            // and the animations fed that float (wrapped here only for the comparison)
+            float seconds = static_cast<float>(Clock::toSeconds(now));
+            double floatDt = seconds - lastSeconds;
+            double floatPhase = std::fmod(static_cast<double>(seconds), periodSeconds());
+            result.MinFloatDt = std::min(result.MinFloatDt, floatDt);
+            result.MaxFloatDt = std::max(result.MaxFloatDt, floatDt);
+            result.MaxFloatPhaseError = std::max(result.MaxFloatPhaseError, phaseError(floatPhase, exactPhase));
+            last = now;
+            lastSeconds = seconds;
+        }
+        return result;
+    }
+
+    struct AccumulationResult {
+        double MaxStepError = 0.0;      // s, one frame added to the game time vs the real frame
+        double MaxPhaseStepError = 0.0; // s, how far Clock::phase moved vs the real frame
+        double Drift = 0.0;             // s, game time - real elapsed time at the end
+        double DriftBound = 0.0;        // s, what STEP_TOLERANCE allows over all the frames
+        double MinFloatStep = 1.0;      // s, the same frames added to a float game time
+        double MaxFloatStep = 0.0;
+    };
+
+    // Game time over days of 60Hz frames, as Game::update keeps it. dt comes from the frame timestamps
+    // like the main loop's deltaTime, or is the simulation thread's fixed step
+    AccumulationResult checkAccumulation(bool fixedStep, bool verbose){
+        const float STEP = 1.0f / 60.0f;
+        AccumulationResult result;
+        uint64_t time = 0;
+        float floatTime = 0.0f; // The game time before Clock: a float adding dt
+        uint64_t last = frameTime(0, 0);
+        double lastPhase = Clock::phase(time, Clock::EFFECT_PERIOD_NS);
+        uint64_t frames = LAST_DAY * FRAMES_PER_DAY;
+        for (uint64_t frame = 1; frame <= frames; ++frame){
+            uint64_t now = frameTime(0, frame);
+            double realDt = Clock::toSeconds(now - last);
+            float dt = fixedStep ? STEP : static_cast<float>(Clock::toSeconds(now - last));
+            uint64_t before = time;
+            time += Clock::fromSeconds(dt);
+            double phase = Clock::phase(time, Clock::EFFECT_PERIOD_NS);
+            result.MaxStepError = std::max(result.MaxStepError, std::abs(Clock::toSeconds(time - before) - realDt));
+            result.MaxPhaseStepError = std::max(result.MaxPhaseStepError, std::abs(phaseStep(lastPhase, phase) - realDt));
+            float floatBefore = floatTime;
+            floatTime += dt;
+            double floatStep = static_cast<double>(floatTime) - floatBefore;
+            result.MinFloatStep = std::min(result.MinFloatStep, floatStep);
+            result.MaxFloatStep = std::max(result.MaxFloatStep, floatStep);
+            last = now;
+            lastPhase = phase;
+            if (verbose && frame % (7 * FRAMES_PER_DAY) == 0)
+                std::printf("%s, day %2d: game time - real time %.6f s, float game time steps %.3f-%.3f ms\n",
+                            fixedStep ? "fixed step" : "frame dt", static_cast<int>(frame / FRAMES_PER_DAY),
+                            Clock::toSeconds(time) - Clock::toSeconds(now), result.MinFloatStep * 1e3, result.MaxFloatStep * 1e3);
+        }
+        result.Drift = (static_cast<double>(time) - static_cast<double>(last)) / 1e9;
+        result.DriftBound = frames * STEP_TOLERANCE;
+        return result;
+    }
+}
+
+int main(int argc, char *argv[]){
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i){
+        if (std::strcmp(argv[i], "--verbose") == 0)
+            verbose = true;
+        else{
+            std::cout << "ERROR::CLOCKCHECK: Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    int failures = 0;
+    DayResult worst;
+    worst.MinFloatDt = 1.0;
+    bool floatBroken = false;
+    for (int day = FIRST_DAY; day <= LAST_DAY; ++day){
+        DayResult result = checkDay(day);
+        if (verbose)
+            std::printf("day %2d: dt error %.3g s, phase error %.3g s | float dt %.3f-%.3f ms, float phase error %.3g s\n",
+                        day, result.MaxDtError, result.MaxPhaseError, result.MinFloatDt * 1e3, result.MaxFloatDt * 1e3,
+                        result.MaxFloatPhaseError);
+        if (result.MaxDtError > DT_TOLERANCE){
+            std::cout << "ERROR::CLOCKCHECK: Frame time off by " << result.MaxDtError << " s after " << day << " days" << std::endl;
+            ++failures;
+        }
+        if (result.MaxPhaseError > PHASE_TOLERANCE){
+            std::cout << "ERROR::CLOCKCHECK: Animation phase off by " << result.MaxPhaseError << " s after " << day << " days" << std::endl;
+            ++failures;
+        }
+        if (std::abs(result.MinFloatDt - FRAME_SECONDS) > FLOAT_BROKEN || std::abs(result.MaxFloatDt - FRAME_SECONDS) > FLOAT_BROKEN)
+            floatBroken = true;
+        worst.MaxDtError = std::max(worst.MaxDtError, result.MaxDtError);
+        worst.MaxPhaseError = std::max(worst.MaxPhaseError, result.MaxPhaseError);
+        worst.MinFloatDt = std::min(worst.MinFloatDt, result.MinFloatDt);
+        worst.MaxFloatDt = std::max(worst.MaxFloatDt, result.MaxFloatDt);
+        worst.MaxFloatPhaseError = std::max(worst.MaxFloatPhaseError, result.MaxFloatPhaseError);
+    }
+    std::printf("Days %d-%d at 60Hz: dt error %.3g s, phase error %.3g s (float seconds: dt %.3f-%.3f ms, phase error %.3g s)\n",
+                FIRST_DAY, LAST_DAY, worst.MaxDtError, worst.MaxPhaseError, worst.MinFloatDt * 1e3, worst.MaxFloatDt * 1e3,
+                worst.MaxFloatPhaseError);
+
+    for (bool fixedStep : { false, true }){
+        const char* path = fixedStep ? "fixed step" : "frame dt";
+        AccumulationResult result = checkAccumulation(fixedStep, verbose);
+        if (result.MaxStepError > STEP_TOLERANCE){
+            std::cout << "ERROR::CLOCKCHECK: Game time (" << path << ") moved by a frame off by " << result.MaxStepError << " s" << std::endl;
+            ++failures;
+        }
+        if (result.MaxPhaseStepError > PHASE_TOLERANCE){
+            std::cout << "ERROR::CLOCKCHECK: Animation phase (" << path << ") moved by a frame off by " << result.MaxPhaseStepError << " s" << std::endl;
+            ++failures;
+        }
+        if (std::abs(result.Drift) > result.DriftBound){
+            std::cout << "ERROR::CLOCKCHECK: Game time (" << path << ") drifted " << result.Drift << " s from real time" << std::endl;
+            ++failures;
+        }
+        if (std::abs(result.MinFloatStep - FRAME_SECONDS) > FLOAT_BROKEN || std::abs(result.MaxFloatStep - FRAME_SECONDS) > FLOAT_BROKEN)
+            floatBroken = true;
+        std::printf("Game time over %d days (%s): frame step error %.3g s, phase step error %.3g s, drift %.6f s (bound %.3f s)"
+                    " (float game time: steps %.3f-%.3f ms)\n",
+                    LAST_DAY, path, result.MaxStepError, result.MaxPhaseStepError, result.Drift, result.DriftBound,
+                    result.MinFloatStep * 1e3, result.MaxFloatStep * 1e3);
+    }
+    // Float seconds lose whole frames well within these days: if they look fine, the check is not checking
+    if (!floatBroken){
+        std::cout << "ERROR::CLOCKCHECK: Float seconds still give 60Hz frame times after " << LAST_DAY
+                  << " days, so this check cannot detect the float time bug" << std::endl;
+        ++failures;
+    }
+    std::cout << (failures ? "FAILED" : "OK") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+//
+//  LevelGenerator.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+// Command line tool that writes a procedurally generated level (see
+// ProceduralLevel) as a .lvl file the game can load with --level, e.g.:
+//   LevelGenerator stress.lvl --size 500x250 --density 0.8 --solid 0.2 --colors 3 --seed 7
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "ProceduralLevel.hpp"
+
+int main(int argc, char *argv[]){
+    if (argc < 2){
+        std::cout << "Usage: " << argv[0] << " <output.lvl> [--size <width>x<height>] [--density <0-1>]"
+                  << " [--solid <0-1>] [--colors <1-4>] [--seed <n>]" << std::endl;
+        return 1;
+    }
+    LevelSpec spec;
+    for (int i = 2; i < argc; ++i){
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc){
+            if (std::sscanf(argv[++i], "%dx%d", &spec.Width, &spec.Height) != 2){
+                std::cout << "ERROR::LEVELGENERATOR: Invalid size " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--density") == 0 && i + 1 < argc)
+            spec.Density = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--solid") == 0 && i + 1 < argc)
+            spec.SolidRatio = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--colors") == 0 && i + 1 < argc)
+            spec.Colors = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            spec.Seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else{
+            std::cout << "ERROR::LEVELGENERATOR: Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    GameLevel level = ProceduralLevel::generate(spec);
+    if (level._boardData.empty() || !ProceduralLevel::write(level, argv[1]))
+        return 1;
+    std::cout << "Wrote a " << spec.Width << "x" << spec.Height << " level to " << argv[1] << std::endl;
+    return 0;
+}
@@ -0,0 +1,507 @@
+//
+//  Microbenchmarks.cpp
+//  Breakout Game
+//
+//  Copyright © 2020 Miguel Lopes. All rights reserved.
+//
+
+// Command line tool timing the hot paths of the game in isolation: the
+// collision tests, the particle update, level parsing, building and checking
+// tile boards, and text layout. Nothing but text layout needs OpenGL (it runs
+// on a headless context, and is skipped when none can be created). Run it
+// from the game directory, as it reads Resources/, e.g.:
+//   Microbenchmarks --out baseline.json --samples 50 --filter collision
+//
+// Every benchmark is warmed up, then its iterations per sample are doubled
+// until a sample takes at least MIN_SAMPLE_NS, so the clock's resolution and
+// overhead are negligible. The results (ns per operation) are the median and
+// the median absolute deviation, which outliers (a preemption, a page fault)
+// barely move, next to the mean, standard deviation and 95% confidence
+// interval of the mean. The batched narrowphase kernels are checked against
+// checkCollision, bit for bit, before they are timed.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Clock.hpp"
+#include "Collision.hpp"
+#include "Narrowphase.hpp"
+#include "CollisionStage.hpp"
+#include "GameLevel.hpp"
+#include "GameModel.hpp"
+#include "ParticleGenerator.hpp"
+#include "ProceduralLevel.hpp"
+#include "TextRenderer.hpp"
+#include "WindowManager.hpp"
+
+namespace {
+    const uint64_t MIN_SAMPLE_NS = 1000000;  // 1 ms
+    const uint64_t WARMUP_NS = 50000000;     // 50 ms
+    const uint64_t MAX_ITERATIONS = 1ull << 30;
+    const int DEFAULT_SAMPLES = 30;
+
+    // Results are folded into it so the compiler cannot drop the work being timed
+    volatile uint64_t sink;
+    template <typename T>
+    void keep(const T& value){
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, std::min(sizeof(value), sizeof(bits)));
+        sink = sink + bits;
+    }
+
+    struct Benchmark {
+        std::string Name;
+        // What one operation is, for the report
+        std::string Operation;
+        // Runs the operation iterations times
+        std::function<void(uint64_t iterations)> Run;
+    };
+
+    struct Result {
+        std::string Name;
+        std::string Operation;
+        uint64_t Iterations = 0; // Per sample
+        std::vector<double> Samples; // ns per operation, sorted
+        double Median = 0.0, Mean = 0.0, StdDev = 0.0, Mad = 0.0, Ci95 = 0.0;
+    };
+
+    double median(const std::vector<double>& sorted){
+        std::size_t n = sorted.size();
+        return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+    }
+
+    // Two-sided 95% quantile of Student's t distribution with n - 1 degrees of freedom
+    double studentT95(std::size_t n){
+        const double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+        std::size_t freedom = n - 1;
+        if (freedom == 0)
+            return 0.0;
+        return freedom <= 30 ? table[freedom - 1] : 1.960;
+    }
+
+    uint64_t timeRun(const Benchmark& benchmark, uint64_t iterations){
+        uint64_t begin = Clock::now();
+        benchmark.Run(iterations);
+        return Clock::now() - begin;
+    }
+
+    Result measure(const Benchmark& benchmark, int samples){
+        Result result;
+        result.Name = benchmark.Name;
+        result.Operation = benchmark.Operation;
+        // Warm up caches, branch predictors and the CPU clock
+        uint64_t warmupEnd = Clock::now() + WARMUP_NS;
+        while (Clock::now() < warmupEnd)
+            benchmark.Run(1);
+        uint64_t iterations = 1;
+        while (timeRun(benchmark, iterations) < MIN_SAMPLE_NS && iterations < MAX_ITERATIONS)
+            iterations *= 2;
+        result.Iterations = iterations;
+        for (int i = 0; i < samples; ++i)
+            result.Samples.push_back(static_cast<double>(timeRun(benchmark, iterations)) / iterations);
+        std::sort(result.Samples.begin(), result.Samples.end());
+
+        std::size_t n = result.Samples.size();
+        result.Median = median(result.Samples);
+        for (double sample : result.Samples)
+            result.Mean += sample;
+        result.Mean /= n;
+        double squares = 0.0;
+        for (double sample : result.Samples)
+            squares += (sample - result.Mean) * (sample - result.Mean);
+        result.StdDev = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+        result.Ci95 = studentT95(n) * result.StdDev / std::sqrt(static_cast<double>(n));
+        std::vector<double> deviations;
+        for (double sample : result.Samples)
+            deviations.push_back(std::fabs(sample - result.Median));
+        std::sort(deviations.begin(), deviations.end());
+        result.Mad = median(deviations);
+        return result;
+    }
+
+    // Object pairs laid out like a game frame: a ball and bricks of the default level's size,
+    // about a quarter of them touching
+    struct CollisionScene {
+        std::vector<BallObject> Balls;
+        std::vector<GameObject> Bricks;
+    };
+
+    CollisionScene makeCollisionScene(std::size_t pairs){
+        CollisionScene scene;
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> position(0.0f, 800.0f);
+        std::uniform_real_distribution<float> offset(-40.0f, 40.0f);
+        for (std::size_t i = 0; i < pairs; ++i){
+            glm::vec2 brick(position(random), position(random) * 0.5f);
+            glm::vec2 ball = brick + glm::vec2(offset(random), offset(random));
+            scene.Bricks.push_back(GameObject(brick, glm::vec2(53.3f, 37.5f), TextureView()));
+            scene.Balls.push_back(BallObject(ball, 12.5f, glm::vec2(100.0f, -350.0f), TextureView()));
+        }
+        return scene;
+    }
+
+    // A board laid out like GameView does on an 800x600 screen, a quarter of its bricks destroyed
+    std::vector<std::vector<GameObject>> makeBrickRows(int width, int height){
+        std::mt19937 random(3);
+        float unitWidth = 800.0f / width;
+        float unitHeight = 300.0f / height;
+        std::vector<std::vector<GameObject>> rows(height);
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x){
+                rows[y].push_back(GameObject(glm::vec2(unitWidth * x, unitHeight * y), glm::vec2(unitWidth, unitHeight), TextureView()));
+                rows[y].back()._destroyed = random() % 4 == 0;
+            }
+        return rows;
+    }
+
+    // Ball positions over the board: anywhere, and exactly touching a brick's edges and corners
+    std::vector<BallObject> makeBallPositions(const std::vector<std::vector<GameObject>>& rows, std::size_t count){
+        std::mt19937 random(4);
+        std::uniform_real_distribution<float> anywhere(-20.0f, 820.0f);
+        const float radius = 12.5f;
+        std::vector<BallObject> balls;
+        for (std::size_t i = 0; i < count; ++i){
+            glm::vec2 position(anywhere(random), anywhere(random) * 0.5f);
+            if (i % 2){
+                const auto& row = rows[random() % rows.size()];
+                const GameObject& brick = row[random() % row.size()];
+                const float offsets[] = { -2.0f * radius, -radius, 0.0f, brick._size.x / 2 - radius, brick._size.x - radius, brick._size.x };
+                const float offsetsY[] = { -2.0f * radius, -radius, 0.0f, brick._size.y / 2 - radius, brick._size.y - radius, brick._size.y };
+                position = brick._position + glm::vec2(offsets[random() % 6], offsetsY[random() % 6]);
+            }
+            balls.push_back(BallObject(position, radius, glm::vec2(100.0f, -350.0f), TextureView()));
+        }
+        return balls;
+    }
+
+    // The contacts checkCollision finds brick by brick, the reference every kernel must match
+    void referenceContacts(const BallObject& ball, const std::vector<std::vector<GameObject>>& rows, std::vector<Contact>& contacts){
+        uint32_t index = 0;
+        for (const auto& row : rows)
+            for (const GameObject& brick : row){
+                if (!brick._destroyed){
+                    Collision collision = checkCollision(ball, brick);
+                    if (std::get<0>(collision))
+                        contacts.push_back({ index, std::get<1>(collision), std::get<2>(collision) });
+                }
+                ++index;
+            }
+    }
+
+    bool sameContacts(const std::vector<Contact>& one, const std::vector<Contact>& two){
+        if (one.size() != two.size())
+            return false;
+        for (std::size_t i = 0; i < one.size(); ++i)
+            if (one[i].Brick != two[i].Brick || one[i].Dir != two[i].Dir
+                || std::memcmp(&one[i].Difference, &two[i].Difference, sizeof(glm::vec2)) != 0)
+                return false;
+        return true;
+    }
+
+    const NarrowphaseKernel KERNELS[] = { NarrowphaseKernel::Scalar, NarrowphaseKernel::SSE, NarrowphaseKernel::AVX2 };
+
+    // Checks every kernel this CPU runs against the reference, bit for bit, and that the collision
+    // stage's broadphase leaves none of the reference contacts out
+    bool verifyNarrowphase(std::ostream& log){
+        const int sizes[][2] = { {15, 8}, {60, 32}, {250, 125} };
+        std::size_t positions = 0, contacts = 0;
+        for (const auto& size : sizes){
+            auto rows = makeBrickRows(size[0], size[1]);
+            BrickSoA bricks;
+            bricks.assign(rows);
+            CollisionStage stage;
+            stage.setBricks(rows);
+            std::vector<Contact> expected, actual;
+            for (const BallObject& ball : makeBallPositions(rows, 20000)){
+                expected.clear();
+                referenceContacts(ball, rows, expected);
+                contacts += expected.size();
+                ++positions;
+                for (NarrowphaseKernel kernel : KERNELS){
+                    if (!Narrowphase::isSupported(kernel))
+                        continue;
+                    actual.clear();
+                    Narrowphase::collide(ball, bricks, actual, kernel);
+                    if (!sameContacts(expected, actual)){
+                        std::cout << "ERROR::MICROBENCHMARKS: The " << Narrowphase::kernelName(kernel) << " narrowphase differs from checkCollision at ("
+                                  << ball._position.x << ", " << ball._position.y << ") on a " << size[0] << "x" << size[1] << " board" << std::endl;
+                        return false;
+                    }
+                }
+                actual.clear();
+                for (const BrickContact& contact : stage.gather(ball))
+                    actual.push_back(contact.Hit);
+                std::sort(actual.begin(), actual.end(), [](const Contact& one, const Contact& two){ return one.Brick < two.Brick; });
+                if (!sameContacts(expected, actual)){
+                    std::cout << "ERROR::MICROBENCHMARKS: The collision stage differs from checkCollision at ("
+                              << ball._position.x << ", " << ball._position.y << ") on a " << size[0] << "x" << size[1] << " board" << std::endl;
+                    return false;
+                }
+            }
+        }
+        log << "Narrowphase kernels and the collision stage match checkCollision on " << positions << " ball positions (" << contacts << " contacts)" << std::endl;
+        return true;
+    }
+
+    void addNarrowphaseBenchmarks(std::vector<Benchmark>& benchmarks){
+        const int sizes[][2] = { {15, 8}, {250, 125} };
+        for (const auto& size : sizes){
+            std::string board = std::to_string(size[0]) + "x" + std::to_string(size[1]);
+            std::string operation = "ball vs " + board + " bricks";
+            auto rows = std::make_shared<std::vector<std::vector<GameObject>>>(makeBrickRows(size[0], size[1]));
+            auto balls = std::make_shared<std::vector<BallObject>>(makeBallPositions(*rows, 256));
+            benchmarks.push_back({ "collision/bricks/aos/" + board, operation, [rows, balls](uint64_t iterations){
+                std::vector<Contact> contacts;
+                for (uint64_t i = 0; i < iterations; ++i){
+                    contacts.clear();
+                    referenceContacts((*balls)[i % balls->size()], *rows, contacts);
+                }
+                keep(contacts.size());
+            }});
+            auto stage = std::make_shared<CollisionStage>();
+            stage->setBricks(*rows);
+            benchmarks.push_back({ "collision/bricks/stage/" + board, operation + " (broadphase first)", [stage, balls](uint64_t iterations){
+                std::size_t contacts = 0;
+                for (uint64_t i = 0; i < iterations; ++i)
+                    contacts += stage->gather((*balls)[i % balls->size()]).size();
+                keep(contacts);
+            }});
+            auto bricks = std::make_shared<BrickSoA>();
+            bricks->assign(*rows);
+            for (NarrowphaseKernel kernel : KERNELS){
+                if (!Narrowphase::isSupported(kernel))
+                    continue;
+                benchmarks.push_back({ std::string("collision/bricks/") + Narrowphase::kernelName(kernel) + "/" + board, operation,
+                                       [bricks, balls, kernel](uint64_t iterations){
+                    std::vector<Contact> contacts;
+                    for (uint64_t i = 0; i < iterations; ++i){
+                        contacts.clear();
+                        Narrowphase::collide((*balls)[i % balls->size()], *bricks, contacts, kernel);
+                    }
+                    keep(contacts.size());
+                }});
+            }
+        }
+    }
+
+    bool matches(const std::string& name, const std::string& filter){
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    void addCollisionBenchmarks(std::vector<Benchmark>& benchmarks){
+        const std::size_t PAIRS = 1024;
+        auto scene = std::make_shared<CollisionScene>(makeCollisionScene(PAIRS));
+        benchmarks.push_back({ "collision/aabb", "rectangle pair", [scene, PAIRS](uint64_t iterations){
+            uint64_t hits = 0;
+            for (uint64_t i = 0; i < iterations; ++i)
+                hits += checkCollision(static_cast<const GameObject&>(scene->Balls[i % PAIRS]), scene->Bricks[i % PAIRS]);
+            keep(hits);
+        }});
+        benchmarks.push_back({ "collision/circle-aabb", "ball-brick pair", [scene, PAIRS](uint64_t iterations){
+            uint64_t hits = 0;
+            for (uint64_t i = 0; i < iterations; ++i){
+                Collision collision = checkCollision(scene->Balls[i % PAIRS], scene->Bricks[i % PAIRS]);
+                hits += std::get<0>(collision) + std::get<1>(collision);
+            }
+            keep(hits);
+        }});
+        auto vectors = std::make_shared<std::vector<glm::vec2>>();
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+        for (std::size_t i = 0; i < PAIRS; ++i)
+            vectors->push_back(glm::vec2(component(random), component(random)));
+        benchmarks.push_back({ "collision/vectorDirection", "vector", [vectors, PAIRS](uint64_t iterations){
+            uint64_t directions = 0;
+            for (uint64_t i = 0; i < iterations; ++i)
+                directions += vectorDirection((*vectors)[i % PAIRS]);
+            keep(directions);
+        }});
+    }
+
+    void addParticleBenchmarks(std::vector<Benchmark>& benchmarks){
+        // Same setup as the game: 500 particles, 2 respawned per tick behind the ball. Without a
+        // GL context the generator only simulates (its GL objects are created on the first draw)
+        auto particles = std::make_shared<ParticleGenerator>(Shader(), TextureView(), 500);
+        auto ball = std::make_shared<BallObject>(glm::vec2(400.0f, 300.0f), 12.5f, glm::vec2(100.0f, -350.0f), TextureView());
+        benchmarks.push_back({ "particles/update", "tick of 500 particles", [particles, ball](uint64_t iterations){
+            for (uint64_t i = 0; i < iterations; ++i)
+                particles->update(1.0f / 60.0f, *ball, 2, glm::vec2(ball->_radius / 2.0f));
+            keep(particles->liveCount());
+        }});
+    }
+
+    void addLevelBenchmarks(std::vector<Benchmark>& benchmarks){
+        benchmarks.push_back({ "level/load", "Resources/levels/one.lvl", [](uint64_t iterations){
+            for (uint64_t i = 0; i < iterations; ++i){
+                GameLevel level;
+                level.load("Resources/levels/one.lvl");
+                keep(level._boardData.size());
+            }
+        }});
+        LevelSpec spec;
+        spec.Width = 500;
+        spec.Height = 250;
+        auto text = std::make_shared<std::string>(ProceduralLevel::toText(ProceduralLevel::generate(spec)));
+        benchmarks.push_back({ "level/loadFromMemory/500x250", "level parse", [text](uint64_t iterations){
+            for (uint64_t i = 0; i < iterations; ++i){
+                GameLevel level;
+                level.loadFromMemory(text->data(), text->size());
+                keep(level._boardData.size());
+            }
+        }});
+    }
+
+    void addModelBenchmarks(std::vector<Benchmark>& benchmarks){
+        // Boards are built here so every benchmark can run on its own, whatever the filter selects
+        auto model = std::make_shared<GameModel>();
+        model->init();
+        model->createBoardTiles();
+        benchmarks.push_back({ "model/createBoardTiles", "4 built-in levels", [model](uint64_t iterations){
+            for (uint64_t i = 0; i < iterations; ++i)
+                keep(model->createBoardTiles().size());
+        }});
+        benchmarks.push_back({ "model/isCompleted/15x8", "check", [model](uint64_t iterations){
+            model->setCurrentLevel(0);
+            for (uint64_t i = 0; i < iterations; ++i)
+                keep(model->isCompleted());
+        }});
+        // isCompleted() copies the whole board before scanning it, so its size matters
+        LevelSpec spec;
+        spec.Width = 500;
+        spec.Height = 250;
+        auto large = std::make_shared<GameModel>();
+        large->init();
+        large->createBoardTiles();
+        large->setLevel(ProceduralLevel::generate(spec));
+        benchmarks.push_back({ "model/isCompleted/500x250", "check", [large](uint64_t iterations){
+            for (uint64_t i = 0; i < iterations; ++i)
+                keep(large->isCompleted());
+        }});
+    }
+
+    void addTextBenchmarks(std::vector<Benchmark>& benchmarks, std::shared_ptr<TextRenderer> text){
+        auto quads = std::make_shared<std::vector<GlyphQuad>>();
+        benchmarks.push_back({ "text/layout/hud", "\"Lives:3\"", [text, quads](uint64_t iterations){
+            for (uint64_t i = 0; i < iterations; ++i){
+                text->layoutText("Lives:3", 5.0f, 5.0f, 1.0f, *quads);
+                keep(quads->back().X);
+            }
+        }});
+        auto line = std::make_shared<std::string>("Press ENTER to start or ESC to quit. Press W or S to select level");
+        benchmarks.push_back({ "text/layout/line", "66 character line", [text, quads, line](uint64_t iterations){
+            for (uint64_t i = 0; i < iterations; ++i){
+                text->layoutText(*line, 250.0f, 300.0f, 0.75f, *quads);
+                keep(quads->back().X);
+            }
+        }});
+    }
+
+    void writeJson(std::ostream& out, const std::vector<Result>& results, int samples){
+        out << std::fixed << std::setprecision(3);
+        out << "{\n  \"benchmark\": \"micro\",\n  \"unit\": \"ns/op\",\n  \"samples\": " << samples
+            << ",\n  \"min_sample_ms\": " << MIN_SAMPLE_NS / 1e6 << ",\n  \"results\": [";
+        for (std::size_t r = 0; r < results.size(); ++r){
+            const Result& result = results[r];
+            out << (r ? "," : "") << "\n    {\"name\": \"" << result.Name << "\", \"operation\": \"";
+            for (char c : result.Operation)
+                out << (c == '"' ? "\\\"" : std::string(1, c));
+            out << "\", \"iterations\": " << result.Iterations
+                << ", \"median\": " << result.Median << ", \"mad\": " << result.Mad
+                << ", \"mean\": " << result.Mean << ", \"stddev\": " << result.StdDev
+                << ", \"ci95\": " << result.Ci95 << ", \"min\": " << result.Samples.front()
+                << ", \"max\": " << result.Samples.back() << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char *argv[]){
+    std::string outFile;
+    std::string filter;
+    int samples = DEFAULT_SAMPLES;
+    for (int i = 1; i < argc; ++i){
+        if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outFile = argv[++i];
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+            samples = std::max(2, std::atoi(argv[++i]));
+        else{
+            std::cout << "Usage: " << argv[0] << " [--out <results.json>] [--filter <name substring>] [--samples <n>]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Without --out the JSON goes to stdout, so progress goes to stderr
+    std::ostream& log = outFile.empty() ? std::cerr : std::cout;
+
+    // Text layout needs the font's glyph metrics, which the renderer only loads along with the
+    // glyph textures
+    WindowManager window;
+    std::shared_ptr<TextRenderer> text;
+    if (matches("text/layout/", filter) || filter.find("text/layout/") == 0){
+#if BREAKOUT_HEADLESS
+        if (window.createHeadless(800, 600)){
+            window.configureOpenGL();
+            text = std::make_shared<TextRenderer>(800, 600);
+            text->load("Resources/fonts/OCRAEXT.TTF", 24);
+        }
+#endif
+        if (!text)
+            log << "Skipping text benchmarks: no OpenGL context to load the font" << std::endl;
+    }
+
+    std::vector<Benchmark> benchmarks;
+    addCollisionBenchmarks(benchmarks);
+    addNarrowphaseBenchmarks(benchmarks);
+    addParticleBenchmarks(benchmarks);
+    addLevelBenchmarks(benchmarks);
+    addModelBenchmarks(benchmarks);
+    if (text)
+        addTextBenchmarks(benchmarks, text);
+
+    bool timesNarrowphase = std::any_of(benchmarks.begin(), benchmarks.end(), [&](const Benchmark& benchmark){
+        return matches(benchmark.Name, filter) && benchmark.Name.find("collision/bricks/") == 0;
+    });
+    if (timesNarrowphase && !verifyNarrowphase(log))
+        return 1;
+
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : benchmarks){
+        if (!matches(benchmark.Name, filter))
+            continue;
+        Result result = measure(benchmark, samples);
+        log << std::left << std::setw(32) << result.Name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << result.Median << " ns/op  +/- " << std::setw(8) << result.Mad << " (MAD)  "
+                  << result.Iterations << " x " << samples << std::defaultfloat << std::endl;
+        results.push_back(std::move(result));
+    }
+
+    if (outFile.empty())
+        writeJson(std::cout, results, samples);
+    else{
+        std::ofstream out(outFile, std::ios::trunc);
+        if (!out){
+            std::cout << "ERROR::MICROBENCHMARKS: Failed to write " << outFile << std::endl;
+            return 1;
+        }
+        writeJson(out, results, samples);
+        std::cout << "Wrote " << results.size() << " results to " << outFile << std::endl;
+    }
+    // The renderer owns GL objects, so it must go before the context
+    text.reset();
+    return 0;
+}
@@ -15,63 +15,397 @@
  ** option) any later version.
  ******************************************************************/
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "WindowManager.hpp"
 #include "Game.hpp"
 #include "ResourceManager.hpp"
+#include "GLResource.hpp"
+#include "ProgramCache.hpp"
+#include "Profiler.hpp"
+#include "Clock.hpp"
+#include "RenderStats.hpp"
+#include "FrameCapture.hpp"
+#include "FrameRecorder.hpp"
+#include "FramePacer.hpp"
+#include "InputManager.hpp"
+#include "Screen.hpp"
+#include "ProceduralLevel.hpp"
+#include "ScalingBenchmark.hpp"
 
 
 // GLFW function declerations
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
-// The Width of the screen
+// The default width of the screen
 const GLuint SCREEN_WIDTH = 800;
-// The height of the screen
+// The default height of the screen
 const GLuint SCREEN_HEIGHT = 600;
+// Length of a simulation tick when the simulation runs on its own thread
+const float SIMULATION_STEP = 1.0f / 60.0f;
+// Seconds an idle screen keeps polling after it last changed or got a key press, before it stops pacing and
+// waits for events. In time rather than frames: skipped frames don't swap, so they can go by in microseconds,
+// faster than the simulation can show the effect of a key
+const double IDLE_TIME_BEFORE_WAIT = 0.5;
+// Longest wait for events on an idle screen, in seconds (bounds how late a timed change shows)
+const double IDLE_WAIT_TIMEOUT = 0.25;
 
-Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
+// Headless latency runs have no keyboard: start a game, then tap left and right in turn
+static void scriptLatencyInput(long long frame){
+    if (frame == 1 || frame == 2)
+        InputManager::inject(GLFW_KEY_ENTER, frame == 1);
+    else if (frame >= 10 && frame % 10 == 0)
+        InputManager::inject(frame % 20 == 0 ? GLFW_KEY_A : GLFW_KEY_D, true);
+    else if (frame >= 10 && frame % 10 == 5)
+        InputManager::inject(frame % 20 == 5 ? GLFW_KEY_A : GLFW_KEY_D, false);
+}
 
 int main(int argc, char *argv[]){
+    // Startup time is measured up to the first presented frame
+    uint64_t startupBegin = Clock::now();
+    bool firstFrame = true;
+    
+    // --no-program-cache forces a cold start (every program compiled from source)
+    // --trace <file> records a CPU profile and writes it as Chrome trace JSON on exit
+    // --msaa <samples> sets the MSAA sample count (0 = off), --fxaa enables FXAA
+    // --crt enables the arcade cabinet look (colour grading + scanlines)
+    // --bloom <off|low|medium|high> sets the bloom quality preset (default off; F5 cycles it)
+    // --resolution <width>x<height> overrides the window size (e.g. 1920x1080 to measure GPU cost)
+    // --dynamic-resolution <ms> scales the scene resolution to hold that frame time,
+    //   --min-scale <s> / --max-scale <s> bound the scale (defaults 0.5 and 1)
+    // --headless renders without a window (EGL, no display needed) at a fixed 60Hz clock,
+    //   --frames <n> stops after n frames (default 600 headless), --write-frames <dir> saves every frame as PNG
+    // --record <path> records gameplay in the background (frames are dropped rather than slowing the game),
+    //   --record-format <jpeg|png|raw> picks the output: a directory of images (default jpeg) or one raw RGB24 file
+    // --threaded runs the simulation on its own thread at a fixed 60Hz, so slow GPU frames don't delay it
+    // --latency reports key press to present latency per stage on exit (headless runs script the key presses),
+    //   --late-latch samples the keys again right before drawing the paddle
+    // --pacing <vsync|adaptive|capped|uncapped> picks the frame pacing (default vsync, uncapped headless),
+    //   --fps-cap <n> caps the frame rate at n (implies capped); pacing statistics are reported on exit
+    // --no-idle-skip redraws settled menu/win screens every frame instead of skipping them and waiting for events
+    // --level <file.lvl> plays that level (e.g. from Tools/LevelGenerator), --autoplay plays by itself
+    // --scaling-benchmark <out.json> times the simulation subsystems per tick on generated levels from 15x8 to
+    //   2000x1000 and exits, --bench-sizes <w>x<h>,... picks the sizes, --bench-ticks <n> the ticks per size (default 120)
+    const char* traceFile = nullptr;
+    int msaaSamples = -1;
+    bool fxaa = false;
+    bool crt = false;
+    BloomQuality bloom = BloomQuality::Off;
+    GLuint screenWidth = SCREEN_WIDTH, screenHeight = SCREEN_HEIGHT;
+    float frameTimeTarget = 0.0f, minScale = 0.5f, maxScale = 1.0f;
+    bool headless = false;
+    long long frameLimit = -1;
+    const char* framesDirectory = nullptr;
+    const char* recordPath = nullptr;
+    RecordFormat recordFormat = RecordFormat::JPEG;
+    bool threaded = false;
+    bool measureLatency = false;
+    bool lateLatch = false;
+    bool pacingSet = false;
+    PacingMode pacing = PacingMode::VSync;
+    double fpsCap = 60.0;
+    bool idleSkip = true;
+    const char* levelFile = nullptr;
+    bool autoplay = false;
+    const char* benchmarkFile = nullptr;
+    std::vector<LevelSpec> benchmarkLevels = ScalingBenchmark::defaultLevels();
+    int benchmarkTicks = 120;
+    for (int i = 1; i < argc; ++i){
+        if (std::strcmp(argv[i], "--no-program-cache") == 0)
+            ProgramCache::setEnabled(false);
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            traceFile = argv[++i];
+        else if (std::strcmp(argv[i], "--msaa") == 0 && i + 1 < argc)
+            msaaSamples = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--fxaa") == 0)
+            fxaa = true;
+        else if (std::strcmp(argv[i], "--crt") == 0)
+            crt = true;
+        else if (std::strcmp(argv[i], "--bloom") == 0 && i + 1 < argc){
+            const char* preset = argv[++i];
+            bloom = std::strcmp(preset, "low") == 0    ? BloomQuality::Low
+                  : std::strcmp(preset, "medium") == 0 ? BloomQuality::Medium
+                  : std::strcmp(preset, "high") == 0   ? BloomQuality::High : BloomQuality::Off;
+        }
+        else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc){
+            unsigned width = 0, height = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) == 2 && width > 0 && height > 0){
+                screenWidth = width;
+                screenHeight = height;
+            }
+        }
+        else if (std::strcmp(argv[i], "--dynamic-resolution") == 0 && i + 1 < argc)
+            frameTimeTarget = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--min-scale") == 0 && i + 1 < argc)
+            minScale = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--max-scale") == 0 && i + 1 < argc)
+            maxScale = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frameLimit = std::atoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--write-frames") == 0 && i + 1 < argc)
+            framesDirectory = argv[++i];
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--record-format") == 0 && i + 1 < argc){
+            const char* format = argv[++i];
+            recordFormat = std::strcmp(format, "png") == 0 ? RecordFormat::PNG
+                         : std::strcmp(format, "raw") == 0 ? RecordFormat::Raw : RecordFormat::JPEG;
+        }
+        else if (std::strcmp(argv[i], "--threaded") == 0)
+            threaded = true;
+        else if (std::strcmp(argv[i], "--latency") == 0)
+            measureLatency = true;
+        else if (std::strcmp(argv[i], "--late-latch") == 0)
+            lateLatch = true;
+        else if (std::strcmp(argv[i], "--pacing") == 0 && i + 1 < argc){
+            const char* mode = argv[++i];
+            pacing = std::strcmp(mode, "adaptive") == 0 ? PacingMode::Adaptive
+                   : std::strcmp(mode, "capped") == 0   ? PacingMode::Capped
+                   : std::strcmp(mode, "uncapped") == 0 ? PacingMode::Uncapped : PacingMode::VSync;
+            pacingSet = true;
+        }
+        else if (std::strcmp(argv[i], "--fps-cap") == 0 && i + 1 < argc){
+            fpsCap = std::atof(argv[++i]);
+            pacing = PacingMode::Capped;
+            pacingSet = true;
+        }
+        else if (std::strcmp(argv[i], "--no-idle-skip") == 0)
+            idleSkip = false;
+        else if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+            levelFile = argv[++i];
+        else if (std::strcmp(argv[i], "--autoplay") == 0)
+            autoplay = true;
+        else if (std::strcmp(argv[i], "--scaling-benchmark") == 0 && i + 1 < argc)
+            benchmarkFile = argv[++i];
+        else if (std::strcmp(argv[i], "--bench-ticks") == 0 && i + 1 < argc)
+            benchmarkTicks = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--bench-sizes") == 0 && i + 1 < argc){
+            benchmarkLevels.clear();
+            std::string sizes = argv[++i];
+            for (std::size_t start = 0; start < sizes.size();){
+                std::size_t end = std::min(sizes.find(',', start), sizes.size());
+                LevelSpec spec;
+                if (std::sscanf(sizes.substr(start, end - start).c_str(), "%dx%d", &spec.Width, &spec.Height) == 2)
+                    benchmarkLevels.push_back(spec);
+                start = end + 1;
+            }
+        }
+    }
     
     WindowManager window;
-    window.createWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breakout", nullptr, nullptr);
+    // The game owns GL objects, so it must be destroyed while the context is still alive
+    auto game = std::make_unique<Game>(screenWidth, screenHeight);
+    Game& Breakout = *game;
+    if (headless){
+        if (!window.createHeadless(screenWidth, screenHeight))
+            return EXIT_FAILURE;
+        if (frameLimit < 0)
+            frameLimit = 600;
+    }
+    else
+        window.createWindow(screenWidth, screenHeight, "Breakout", nullptr, nullptr);
     // OpenGL configuration
     window.configureOpenGL();
+    // Headless runs are throughput runs unless asked otherwise
+    if (headless && !pacingSet)
+        pacing = PacingMode::Uncapped;
+    FramePacer pacer(pacing, fpsCap);
+    pacer.configure(window);
     //configure input
-    InputManager::setupKeyInputs(window);
+    if (!headless)
+        InputManager::setupKeyInputs(window);
+    // Use the packed assets when available, loose files from Resources/ otherwise
+    ResourceManager::mountAssetPack("Resources/assets.pack");
+    Breakout.setAntiAliasing(msaaSamples, fxaa);
+    Breakout.setCrtEffect(crt);
+    Breakout.setBloomQuality(bloom);
+    Breakout.setDynamicResolution(frameTimeTarget, minScale, maxScale);
+    Breakout.setLateLatching(lateLatch);
+    Profiler::setThreadName("Main");
+    Profiler::setEnabled(traceFile != nullptr);
     
     // Initialize game
     Breakout.init();
+    if (levelFile != nullptr){
+        GameLevel level;
+        level.load(levelFile);
+        Breakout.loadLevel(level);
+    }
+    Breakout.setAutoplay(autoplay);
+    if (benchmarkFile != nullptr){
+        ScalingBenchmark benchmark(Breakout, benchmarkTicks, SIMULATION_STEP);
+        benchmark.run(benchmarkLevels);
+        benchmark.writeJson(benchmarkFile);
+        // Straight to the teardown
+        frameLimit = 0;
+    }
+    std::unique_ptr<FrameRecorder> recorder;
+    if (recordPath != nullptr)
+        recorder = std::make_unique<FrameRecorder>(recordPath, recordFormat, window.getWidth(), window.getHeight());
     
     // DeltaTime variables
     float deltaTime = 0.0f;
-    float lastFrame = 0.0f;
+    uint64_t lastFrame = window.getTime();
+    long long frameCount = 0;
+    // Recordings need every frame, and scripted input is timed in frames: skipped ones would rush it
+    if (framesDirectory != nullptr || recordPath != nullptr || (headless && measureLatency))
+        idleSkip = false;
+    // Idle-frame skipping: when the screen last changed (or an event woke it up), and where the CPU time went
+    uint64_t lastActivity = Clock::now();
+    long long skippedFrames = 0;
+    double idleWaitSeconds = 0.0;
+    std::clock_t drawnCpu = 0, skippedCpu = 0;
+    std::clock_t cpuBegin = std::clock();
+    uint64_t loopBegin = Clock::now();
+    // Threaded: this thread keeps the GL context (and GLFW's events, which must stay on the main thread)
+    if (threaded)
+        Breakout.startSimulationThread(SIMULATION_STEP);
     
-    while (!window.windowShouldClose()){
-        window.pollEvents();
+    while (!window.windowShouldClose() && (frameLimit < 0 || frameCount < frameLimit)){
+        PROFILE_SCOPE("Frame");
+        std::clock_t frameCpu = std::clock();
+        uint64_t activity = std::max(lastActivity, InputManager::lastQueuedTime());
+        if (idleSkip && Clock::now() - activity >= Clock::fromSeconds(IDLE_TIME_BEFORE_WAIT)){
+            // Low-power mode: nothing to draw until something happens
+            PROFILE_SCOPE("WaitEvents");
+            pacer.pause();
+            uint64_t waitBegin = window.getTime();
+            // Stay awake for a while after an event: its effect may take a few ticks to show
+            if (window.waitEvents(IDLE_WAIT_TIMEOUT))
+                lastActivity = Clock::now();
+            idleWaitSeconds += Clock::toSeconds(window.getTime() - waitBegin);
+        }
+        else{
+            // Wait as late as possible, before sampling input, so the frame starts with the freshest events
+            pacer.wait();
+            window.pollEvents();
+        }
+        if (headless && measureLatency)
+            scriptLatencyInput(frameCount);
         
         // Manage user input
-        Breakout.processInput();//TODO: move this
+        if (!threaded)
+            Breakout.processInput(Clock::now());//TODO: move this
         
         // Calculate delta time
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
+        // Only the difference becomes seconds: the clock itself stays exact however long the game runs
+        uint64_t currentFrame = window.getTime();
+        deltaTime = static_cast<float>(Clock::toSeconds(currentFrame - lastFrame));
         lastFrame = currentFrame;
         
         // Update Game state
-        Breakout.update(deltaTime);
+        if (!threaded)
+            Breakout.update(deltaTime);
         
+        // Late latching: pick up the events that arrived while simulating, right before drawing
+        if (lateLatch)
+            window.pollEvents();
+        // Idle screens that look exactly like the frame on screen are not drawn again
+        if (window.takeRefreshRequest())
+            Breakout.invalidateFrame();
+        if (idleSkip && Breakout.frameUnchanged()){
+            window.skipFrame();
+            ++skippedFrames;
+            ++frameCount;
+            Profiler::endFrame();
+            RenderStats::endFrame();
+            skippedCpu += std::clock() - frameCpu;
+            continue;
+        }
+        lastActivity = Clock::now();
         // Render
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        Breakout.render();
+        Breakout.render(deltaTime);
         
-        glfwSwapBuffers(&window.getWindow());//TODO: put into windowmanager
+        if (framesDirectory != nullptr){
+            char file[64];
+            std::snprintf(file, sizeof(file), "/frame_%05lld.png", frameCount);
+            FrameCapture::writePNG(framesDirectory + std::string(file), Screen::framebuffer(), window.getWidth(), window.getHeight());
+        }
+        if (recorder)
+            recorder->capture(Screen::framebuffer());
+        {
+            PROFILE_SCOPE("SwapBuffers");
+            window.swapBuffers();
+        }
+        Breakout.presented();
+        ++frameCount;
+        // Publish this frame's counters (shown by the debug overlay next frame)
+        Profiler::endFrame();
+        RenderStats::endFrame();
+        drawnCpu += std::clock() - frameCpu;
+        
+        if (firstFrame){
+            firstFrame = false;
+            double startup = Clock::toMilliseconds(Clock::now() - startupBegin);
+            std::cout << "Time to first frame: " << startup << " ms (program cache: "
+                      << ProgramCache::hits() << " hits, " << ProgramCache::misses() << " misses)" << std::endl;
+        }
+    }
+    
+    Breakout.stopSimulationThread();
+    // Nothing to report when no frame ran (e.g. a benchmark run)
+    if (frameCount > 0 && (threaded || headless)){
+        const RunningStats& ticks = Breakout.tickIntervals();
+        std::cout << "Simulation: " << ticks.count() + 1 << " ticks, interval " << ticks.mean() << " ms (sd "
+                  << ticks.stddev() << ", min " << ticks.min() << ", max " << ticks.max() << ")";
+        if (threaded)
+            std::cout << ", start lateness " << Breakout.tickLateness().mean() << " ms (max " << Breakout.tickLateness().max() << ")";
+        std::cout << std::endl;
+        const CollisionCounters& collisions = Breakout.collisionTotals();
+        if (collisions.Ticks > 0)
+            std::cout << "Collisions: " << double(collisions.PairsTested) / collisions.Ticks << " ball-brick pairs tested per tick, "
+                      << collisions.Contacts << " contacts, " << collisions.Resolved << " resolved" << std::endl;
+    }
+    if (frameCount > 0 && (pacingSet || headless))
+        pacer.report(std::cout);
+    if (skippedFrames > 0){
+        // Skipped frames submit no GPU work at all; the CPU share covers every thread of the process
+        double loopSeconds = Clock::toSeconds(Clock::now() - loopBegin);
+        double cpuSeconds = double(std::clock() - cpuBegin) / CLOCKS_PER_SEC;
+        long long drawnFrames = frameCount - skippedFrames;
+        std::cout << "Idle frames: " << skippedFrames << " of " << frameCount << " skipped, " << idleWaitSeconds
+                  << " s waiting for events; CPU " << (loopSeconds > 0.0 ? 100.0 * cpuSeconds / loopSeconds : 0.0)
+                  << "% of a core (drawn frames " << (drawnFrames > 0 ? 1000.0 * drawnCpu / CLOCKS_PER_SEC / drawnFrames : 0.0)
+                  << " ms CPU each, skipped " << 1000.0 * skippedCpu / CLOCKS_PER_SEC / skippedFrames << " ms)" << std::endl;
+    }
+    if (measureLatency)
+        Breakout.inputLatency().report(std::cout);
+    if (frameCount > 0 && headless){
+        // Rendering throughput (wall clock: the game itself runs on the fixed 60Hz clock)
+        double elapsed = Clock::toMilliseconds(Clock::now() - loopBegin);
+        long long drawnFrames = frameCount - skippedFrames;
+        std::cout << "Rendered " << drawnFrames << " frames in " << elapsed << " ms ("
+                  << (elapsed > 0.0 ? drawnFrames * 1000.0 / elapsed : 0.0) << " fps)" << std::endl;
+    }
+    if (recorder){
+        recorder->finish();
+        std::cout << "Recorded " << recorder->writtenFrames() << " of " << recorder->capturedFrames() << " frames as "
+                  << FrameRecorder::formatName(recordFormat) << " (" << recorder->droppedReadbacks() << " dropped at readback, "
+                  << recorder->droppedEncodes() << " dropped at encoding)" << std::endl;
+        recorder.reset();
     }
+    if (traceFile != nullptr && !Profiler::writeChromeTrace(traceFile))
+        std::cout << "ERROR::PROFILER: Failed to write trace " << traceFile << std::endl;
     
     // Delete all resources as loaded using the resource manager
+    game.reset();
     ResourceManager::clear();
+    window.closeWindow();
+    // Every GL object should have been released by its owner by now
+    if (GLResourceStats::totalLiveCount() != 0)
+        std::cout << "WARNING::GLRESOURCE: " << GLResourceStats::totalLiveCount() << " GL objects leaked" << std::endl;
     
     glfwTerminate();
     return 0;